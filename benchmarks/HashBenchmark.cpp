@@ -0,0 +1,108 @@
+// Compares HashUtils against the stringstream / SHA256_Init version it replaced.
+// Build with -DBUILD_BENCHMARKS=ON and run ./hash_benchmark [iterations]
+#include <openssl/sha.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/utils/HashUtils.hpp"
+
+namespace
+{
+  // The deprecated SHA256_* calls are the point of the comparison
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+  std::string legacySha256(const std::string &input)
+  {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256_CTX sha256;
+    SHA256_Init(&sha256);
+    SHA256_Update(&sha256, input.c_str(), input.length());
+    SHA256_Final(hash, &sha256);
+
+    std::stringstream ss;
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++)
+    {
+      ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+    }
+    return ss.str();
+  }
+#pragma GCC diagnostic pop
+
+  // Keeps the optimizer from discarding results
+  volatile size_t sink = 0;
+
+  template <typename Fn>
+  double nsPerOp(size_t iterations, Fn &&fn)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+      fn(i);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / iterations;
+  }
+
+  void report(const std::string &name, double ns, double baseline)
+  {
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << ns << " ns/op" << std::setw(8) << std::setprecision(2) << baseline / ns
+              << "x" << std::endl;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  // Token-sized inputs, like TokenCache keys
+  std::vector<std::string> inputs;
+  for (size_t i = 0; i < 1024; ++i)
+  {
+    inputs.push_back("eyJhbGciOiJIUzI1NiJ9.eyJ1c2VyX2lkIjoi" + std::to_string(i * 7919) + "In0.c2lnbmF0dXJl");
+  }
+
+  if (legacySha256(inputs[0]) != HashUtils::sha256(inputs[0]))
+  {
+    std::cerr << "Digest mismatch" << std::endl;
+    return 1;
+  }
+
+  double legacy = nsPerOp(iterations, [&](size_t i)
+                          { sink += legacySha256(inputs[i % inputs.size()]).size(); });
+  report("legacy sha256 (hex)", legacy, legacy);
+
+  double hex = nsPerOp(iterations, [&](size_t i)
+                       { sink += HashUtils::sha256(inputs[i % inputs.size()]).size(); });
+  report("HashUtils::sha256 (hex)", hex, legacy);
+
+  unsigned char digest[HashUtils::SHA256_BYTES];
+  double raw = nsPerOp(iterations, [&](size_t i)
+                       {
+    const auto &input = inputs[i % inputs.size()];
+    HashUtils::sha256(input.data(), input.size(), digest);
+    sink += digest[0]; });
+  report("HashUtils::sha256 (buffer)", raw, legacy);
+
+  std::vector<std::string_view> views(inputs.begin(), inputs.end());
+  std::vector<HashUtils::Digest> digests(views.size());
+  double batch = nsPerOp(iterations / views.size() + 1, [&](size_t)
+                         {
+    HashUtils::sha256Batch(views, digests.data());
+    sink += digests[0][0]; }) /
+                 views.size();
+  report("HashUtils::sha256Batch", batch, legacy);
+
+  char out[HashUtils::SHA256_HEX_LENGTH];
+  double toHex = nsPerOp(iterations, [&](size_t i)
+                         {
+    HashUtils::toHex(digests[i % digests.size()].data(), HashUtils::SHA256_BYTES, out);
+    sink += out[0]; });
+  std::cout << "toHex of a 32-byte digest: " << std::setprecision(1) << toHex << " ns/op" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,393 @@
+#pragma once
+#include "jwt-cpp/jwt.h"
+#include <nlohmann/json.hpp>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "../config/config.hpp"
+#include "../utils/HashUtils.hpp"
+
+namespace Auth
+{
+  // JWT signing and verification keys, parsed once per configuration and
+  // shared by every request thread.
+  //
+  // Asymmetric keys are PEM files named <kid>.pem in JWT_KEYS_DIR; the key
+  // type picks the algorithm (RSA: RS256, P-256: ES256, Ed25519: EdDSA).
+  // Tokens are signed with the private key JWT_SIGNING_KID and verified with
+  // the key their kid header names, so a key can be rotated in by adding its
+  // file, switching JWT_SIGNING_KID and reloading, and retired by deleting
+  // the file once its tokens have expired. Every key is published as a JWK.
+  // Tokens without a kid are HS256 with JWT_SECRET, when one is set.
+  class KeySet
+  {
+  public:
+    using Verifier = decltype(jwt::verify());
+
+    // Satisfies jwt-cpp's algorithm interface for builder::sign
+    class Signer
+    {
+    public:
+      using SignFunction = std::function<std::string(const std::string &, std::error_code &)>;
+
+      Signer(std::string name, SignFunction sign) : name_(std::move(name)), sign_(std::move(sign)) {}
+
+      std::string name() const { return name_; }
+      std::string sign(const std::string &data, std::error_code &ec) const { return sign_(data, ec); }
+
+    private:
+      std::string name_;
+      SignFunction sign_;
+    };
+
+    bool canSign() const { return signer_.has_value(); }
+    const Signer &signer() const { return *signer_; }
+    // Empty for HS256
+    const std::string &signingKid() const { return signingKid_; }
+
+    bool canVerify() const { return !verifiers_.empty(); }
+
+    // nullptr for an unknown kid
+    const Verifier *verifierFor(const std::string &kid) const
+    {
+      auto it = verifiers_.find(kid);
+      return it == verifiers_.end() ? nullptr : &it->second;
+    }
+
+    // Changes whenever any key does; TokenCache flushes on a new value
+    const std::string &fingerprint() const { return fingerprint_; }
+
+    // Serialized once, served as is
+    const std::string &jwks() const { return jwks_; }
+
+    // Throws std::invalid_argument naming the offending key or setting
+    static std::unique_ptr<KeySet> build(const Config::Settings &settings)
+    {
+      auto keys = std::make_unique<KeySet>();
+      auto jwks = nlohmann::json::array();
+
+      if (!settings.jwtSecret.empty())
+      {
+        keys->verifiers_.emplace("", jwt::verify().allow_algorithm(jwt::algorithm::hs256{settings.jwtSecret}));
+        keys->fingerprint_ = settings.jwtSecret;
+      }
+
+      if (!settings.jwtKeysDir.empty())
+      {
+        for (const auto &file : pemFiles(settings.jwtKeysDir))
+        {
+          auto kid = file.stem().string();
+          auto pem = readFile(file);
+          auto key = Key::parse(kid, pem);
+
+          keys->verifiers_.emplace(kid, key.verifier());
+          if (kid == settings.jwtSigningKid)
+          {
+            if (!key.isPrivate)
+            {
+              throw std::invalid_argument("JWT_SIGNING_KID " + kid + " is a public key");
+            }
+            keys->signer_ = key.signer();
+            keys->signingKid_ = kid;
+          }
+          jwks.push_back(key.jwk());
+          keys->fingerprint_ += "\n" + kid + ":" + HashUtils::sha256(pem);
+        }
+      }
+
+      if (!settings.jwtSigningKid.empty() && !keys->signer_)
+      {
+        throw std::invalid_argument("JWT_SIGNING_KID " + settings.jwtSigningKid + " has no key in JWT_KEYS_DIR");
+      }
+      if (!keys->signer_ && !settings.jwtSecret.empty())
+      {
+        auto hs256 = jwt::algorithm::hs256{settings.jwtSecret};
+        keys->signer_.emplace(hs256.name(), [hs256](const std::string &data, std::error_code &ec)
+                              { return hs256.sign(data, ec); });
+      }
+
+      keys->jwks_ = nlohmann::json({{"keys", jwks}}).dump();
+      return keys;
+    }
+
+  private:
+    std::map<std::string, Verifier> verifiers_;
+    std::optional<Signer> signer_;
+    std::string signingKid_;
+    std::string fingerprint_;
+    std::string jwks_;
+
+    struct PkeyDeleter
+    {
+      void operator()(EVP_PKEY *pkey) const { EVP_PKEY_free(pkey); }
+    };
+
+    struct BignumDeleter
+    {
+      void operator()(BIGNUM *bn) const { BN_free(bn); }
+    };
+
+    // One key file: its parsed form, for the JWK, and its PEM, for jwt-cpp
+    struct Key
+    {
+      std::string kid;
+      std::string pem;
+      std::string alg;
+      bool isPrivate = false;
+      std::unique_ptr<EVP_PKEY, PkeyDeleter> pkey;
+
+      static Key parse(const std::string &kid, const std::string &pem)
+      {
+        Key key;
+        key.kid = kid;
+        key.pem = pem;
+        auto read = [&pem](auto reader)
+        {
+          std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size())), BIO_free);
+          return reader(bio.get(), nullptr, nullptr, nullptr);
+        };
+        key.pkey.reset(read(PEM_read_bio_PrivateKey));
+        key.isPrivate = key.pkey != nullptr;
+        if (!key.pkey)
+        {
+          key.pkey.reset(read(PEM_read_bio_PUBKEY));
+        }
+        if (!key.pkey)
+        {
+          throw std::invalid_argument("JWT key " + kid + " is not a PEM private or public key");
+        }
+
+        switch (EVP_PKEY_get_base_id(key.pkey.get()))
+        {
+        case EVP_PKEY_RSA:
+          if (EVP_PKEY_get_bits(key.pkey.get()) < 2048)
+          {
+            throw std::invalid_argument("JWT key " + kid + " is an RSA key below 2048 bits");
+          }
+          key.alg = "RS256";
+          break;
+        case EVP_PKEY_EC:
+          if (curve(key.pkey.get()) != "prime256v1")
+          {
+            throw std::invalid_argument("JWT key " + kid + " is an EC key not on P-256");
+          }
+          key.alg = "ES256";
+          break;
+        case EVP_PKEY_ED25519:
+          key.alg = "EdDSA";
+          break;
+        default:
+          throw std::invalid_argument("JWT key " + kid + " is not an RSA, P-256 or Ed25519 key");
+        }
+        return key;
+      }
+
+      Verifier verifier() const
+      {
+        auto publicPem = isPrivate ? "" : pem;
+        auto privatePem = isPrivate ? pem : "";
+        if (alg == "RS256")
+        {
+          return jwt::verify().allow_algorithm(jwt::algorithm::rs256(publicPem, privatePem, "", ""));
+        }
+        if (alg == "ES256")
+        {
+          return jwt::verify().allow_algorithm(jwt::algorithm::es256(publicPem, privatePem, "", ""));
+        }
+        return jwt::verify().allow_algorithm(jwt::algorithm::ed25519(publicPem, privatePem, "", ""));
+      }
+
+      Signer signer() const
+      {
+        if (alg == "RS256")
+        {
+          return wrap(jwt::algorithm::rs256("", pem, "", ""));
+        }
+        if (alg == "ES256")
+        {
+          return wrap(jwt::algorithm::es256("", pem, "", ""));
+        }
+        return wrap(jwt::algorithm::ed25519("", pem, "", ""));
+      }
+
+      // RFC 7517 public JWK
+      nlohmann::json jwk() const
+      {
+        nlohmann::json jwk = {{"kid", kid}, {"use", "sig"}, {"alg", alg}};
+        if (alg == "RS256")
+        {
+          jwk["kty"] = "RSA";
+          jwk["n"] = base64url(bignum(OSSL_PKEY_PARAM_RSA_N, 0));
+          jwk["e"] = base64url(bignum(OSSL_PKEY_PARAM_RSA_E, 0));
+        }
+        else if (alg == "ES256")
+        {
+          jwk["kty"] = "EC";
+          jwk["crv"] = "P-256";
+          jwk["x"] = base64url(bignum(OSSL_PKEY_PARAM_EC_PUB_X, 32));
+          jwk["y"] = base64url(bignum(OSSL_PKEY_PARAM_EC_PUB_Y, 32));
+        }
+        else
+        {
+          size_t length = 0;
+          EVP_PKEY_get_raw_public_key(pkey.get(), nullptr, &length);
+          std::string raw(length, '\0');
+          EVP_PKEY_get_raw_public_key(pkey.get(), reinterpret_cast<unsigned char *>(raw.data()), &length);
+          jwk["kty"] = "OKP";
+          jwk["crv"] = "Ed25519";
+          jwk["x"] = base64url(raw);
+        }
+        return jwk;
+      }
+
+      // Big-endian bytes of a key parameter, left-padded to width if nonzero
+      std::string bignum(const char *param, int width) const
+      {
+        BIGNUM *raw = nullptr;
+        if (EVP_PKEY_get_bn_param(pkey.get(), param, &raw) != 1)
+        {
+          throw std::invalid_argument("JWT key " + kid + " has no " + param);
+        }
+        std::unique_ptr<BIGNUM, BignumDeleter> value(raw);
+        std::string bytes(width ? width : BN_num_bytes(value.get()), '\0');
+        BN_bn2binpad(value.get(), reinterpret_cast<unsigned char *>(bytes.data()), static_cast<int>(bytes.size()));
+        return bytes;
+      }
+
+      static std::string curve(EVP_PKEY *pkey)
+      {
+        char name[64] = {};
+        size_t length = 0;
+        if (EVP_PKEY_get_utf8_string_param(pkey, OSSL_PKEY_PARAM_GROUP_NAME, name, sizeof(name), &length) != 1)
+        {
+          return "";
+        }
+        return std::string(name, length);
+      }
+
+      template <typename Algorithm>
+      static Signer wrap(Algorithm algorithm)
+      {
+        return Signer(algorithm.name(), [algorithm](const std::string &data, std::error_code &ec)
+                      { return algorithm.sign(data, ec); });
+      }
+
+      static std::string base64url(const std::string &bytes)
+      {
+        return jwt::base::trim<jwt::alphabet::base64url>(jwt::base::encode<jwt::alphabet::base64url>(bytes));
+      }
+    };
+
+    // Sorted, so the JWKS and fingerprint do not depend on directory order
+    static std::vector<std::filesystem::path> pemFiles(const std::string &dir)
+    {
+      std::vector<std::filesystem::path> files;
+      std::error_code ec;
+      for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+      {
+        if (entry.is_regular_file() && entry.path().extension() == ".pem")
+        {
+          files.push_back(entry.path());
+        }
+      }
+      if (ec)
+      {
+        throw std::invalid_argument("JWT_KEYS_DIR cannot be read: " + dir);
+      }
+      std::sort(files.begin(), files.end());
+      return files;
+    }
+
+    static std::string readFile(const std::filesystem::path &path)
+    {
+      std::ifstream file(path, std::ios::binary);
+      if (!file)
+      {
+        throw std::invalid_argument("JWT key file cannot be read: " + path.string());
+      }
+      std::ostringstream contents;
+      contents << file.rdbuf();
+      return contents.str();
+    }
+  };
+
+  // The current KeySet, published the same way as Config::AppConfig snapshots
+  class KeyStore
+  {
+  public:
+    static const KeySet &current()
+    {
+      auto *keys = state().current.load(std::memory_order_acquire);
+      return keys ? *keys : load();
+    }
+
+    // Throws std::invalid_argument for unusable keys
+    static const KeySet &load()
+    {
+      auto &store = state();
+      std::lock_guard<std::mutex> lock(store.mtx);
+      if (auto *keys = store.current.load(std::memory_order_acquire))
+      {
+        return *keys;
+      }
+      return *publish(store, KeySet::build(Config::AppConfig::current()));
+    }
+
+    // Rebuild from the current config; keeps the old keys if the new ones are unusable
+    static bool reload()
+    {
+      auto &store = state();
+      std::lock_guard<std::mutex> lock(store.mtx);
+      try
+      {
+        publish(store, KeySet::build(Config::AppConfig::current()));
+        return true;
+      }
+      catch (const std::exception &e)
+      {
+        std::cerr << "[KeyStore] Reload rejected: " << e.what() << std::endl;
+        return false;
+      }
+    }
+
+  private:
+    struct State
+    {
+      std::atomic<const KeySet *> current{nullptr};
+      // Superseded sets are kept so verifiers in use stay valid
+      std::vector<std::unique_ptr<KeySet>> sets;
+      std::mutex mtx;
+    };
+
+    static State &state()
+    {
+      static State state;
+      return state;
+    }
+
+    static const KeySet *publish(State &store, std::unique_ptr<KeySet> keys)
+    {
+      store.sets.push_back(std::move(keys));
+      const KeySet *published = store.sets.back().get();
+      store.current.store(published, std::memory_order_release);
+      return published;
+    }
+  };
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include <sw/redis++/redis++.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../config/config.hpp"
+#include "../redis/RedisManager.hpp"
+#include "../redis/RedisScript.hpp"
+#include "../utils/StringUtils.hpp"
+
+namespace Auth
+{
+  // Token-bucket throttling of login attempts per client IP and per email,
+  // shared across nodes through one atomic Redis script.
+  //
+  // To keep Redis off the common path, a refill can lease a few tokens into
+  // a per-process counter that later attempts spend locally, and a rejection
+  // is remembered locally until its retry time, so a credential-stuffing
+  // burst against one key costs one Redis call rather than one per attempt.
+  // Leased tokens have already left the shared bucket, so the cluster-wide
+  // limit still holds; unused ones simply lapse with the lease.
+  class LoginRateLimiter
+  {
+  public:
+    struct Decision
+    {
+      bool allowed = true;
+      int retryAfterSeconds = 0;
+    };
+
+    // Take one attempt from each enabled bucket, or none if any is empty.
+    // Fails open when Redis is unavailable.
+    static Decision acquire(const std::string &ip, const std::string &email)
+    {
+      auto &limiter = instance();
+      const auto &settings = Config::AppConfig::current();
+
+      std::vector<Bucket> buckets;
+      if (settings.loginIpPerMinute > 0 && !ip.empty())
+      {
+        buckets.push_back({"login:ip:" + ip, settings.loginIpPerMinute, settings.loginIpBurst});
+      }
+      if (settings.loginEmailPerMinute > 0 && !email.empty())
+      {
+        buckets.push_back({"login:email:" + StringUtils::toLower(email), settings.loginEmailPerMinute, settings.loginEmailBurst});
+      }
+
+      auto now = Clock::now();
+      std::vector<Bucket *> remote;
+      for (auto &bucket : buckets)
+      {
+        auto state = limiter.takeLocal(bucket.key, now);
+        if (state.blockedFor.count() > 0)
+        {
+          limiter.refund(buckets, now);
+          limiter.localRejected_++;
+          return reject(state.blockedFor);
+        }
+        bucket.leased = state.taken;
+        if (!bucket.leased)
+        {
+          remote.push_back(&bucket);
+        }
+      }
+
+      if (remote.empty())
+      {
+        limiter.localAllowed_++;
+        return {};
+      }
+
+      std::vector<long long> reply;
+      try
+      {
+        reply = limiter.evaluate(remote, settings.loginLimitLease);
+      }
+      catch (const sw::redis::Error &e)
+      {
+        limiter.errors_++;
+        std::cerr << "[LoginRateLimiter] Redis check failed, allowing attempt: " << e.what() << std::endl;
+        return {};
+      }
+
+      bool allowed = std::all_of(reply.begin(), reply.end(), [](long long granted)
+                                 { return granted > 0; });
+      if (!allowed)
+      {
+        limiter.refund(buckets, now);
+        auto wait = std::chrono::milliseconds(0);
+        for (size_t i = 0; i < remote.size(); ++i)
+        {
+          if (reply[i] < 0)
+          {
+            limiter.block(remote[i]->key, now + std::chrono::milliseconds(-reply[i]));
+            wait = std::max(wait, std::chrono::milliseconds(-reply[i]));
+          }
+        }
+        limiter.rejected_++;
+        return reject(wait);
+      }
+
+      // One granted token pays for this attempt; the rest is the lease
+      for (size_t i = 0; i < remote.size(); ++i)
+      {
+        if (reply[i] > 1)
+        {
+          limiter.lease(remote[i]->key, static_cast<int>(reply[i] - 1), now + LEASE_TTL);
+        }
+      }
+      limiter.allowed_++;
+      return {};
+    }
+
+    static nlohmann::json stats()
+    {
+      auto &limiter = instance();
+      size_t keys = 0;
+      for (auto &shard : limiter.shards_)
+      {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        keys += shard.entries.size();
+      }
+
+      return {{"allowed", limiter.allowed_.load()},
+              {"rejected", limiter.rejected_.load()},
+              {"local_allowed", limiter.localAllowed_.load()},
+              {"local_rejected", limiter.localRejected_.load()},
+              {"redis_calls", limiter.redisCalls_.load()},
+              {"errors", limiter.errors_.load()},
+              {"local_keys", keys}};
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t MAX_KEYS_PER_SHARD = 4096;
+    // Unused leased tokens are forfeited after this
+    static constexpr auto LEASE_TTL = std::chrono::seconds(2);
+
+    // KEYS: buckets. ARGV: per key, tokens per minute, burst, tokens wanted.
+    // Either takes from every bucket (reply: tokens granted per key) or from
+    // none (reply: minus the milliseconds until an empty bucket has a token,
+    // 0 for buckets that were fine). Uses the Redis clock so nodes agree.
+    static constexpr const char *TAKE_SOURCE = R"lua(
+local time = redis.call('TIME')
+local now = tonumber(time[1]) * 1000 + math.floor(tonumber(time[2]) / 1000)
+local tokens = {}
+local reply = {}
+local denied = false
+for i, key in ipairs(KEYS) do
+  local rate = tonumber(ARGV[3 * i - 2]) / 60000
+  local burst = tonumber(ARGV[3 * i - 1])
+  local state = redis.call('HMGET', key, 't', 'ts')
+  local t = tonumber(state[1]) or burst
+  local ts = tonumber(state[2]) or now
+  t = math.min(burst, t + math.max(0, now - ts) * rate)
+  tokens[i] = t
+  reply[i] = 0
+  if t < 1 then
+    denied = true
+    reply[i] = -math.ceil((1 - t) / rate)
+  end
+end
+if denied then
+  return reply
+end
+for i, key in ipairs(KEYS) do
+  local rate = tonumber(ARGV[3 * i - 2]) / 60000
+  local burst = tonumber(ARGV[3 * i - 1])
+  local granted = math.min(tonumber(ARGV[3 * i]), math.floor(tokens[i]))
+  redis.call('HSET', key, 't', tostring(tokens[i] - granted), 'ts', now)
+  redis.call('PEXPIRE', key, math.ceil(burst / rate) + 1000)
+  reply[i] = granted
+end
+return reply
+)lua";
+
+    struct Bucket
+    {
+      std::string key;
+      int perMinute;
+      int burst;
+      bool leased = false;
+    };
+
+    struct LocalState
+    {
+      int tokens = 0;
+      Clock::time_point leaseExpiresAt;
+      Clock::time_point blockedUntil;
+    };
+
+    struct TakeResult
+    {
+      bool taken = false;
+      std::chrono::milliseconds blockedFor{0};
+    };
+
+    struct Shard
+    {
+      std::mutex mtx;
+      std::unordered_map<std::string, LocalState> entries;
+    };
+
+    std::array<Shard, SHARDS> shards_;
+    RedisScript take_{TAKE_SOURCE};
+
+    std::atomic<uint64_t> allowed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> localAllowed_{0};
+    std::atomic<uint64_t> localRejected_{0};
+    std::atomic<uint64_t> redisCalls_{0};
+    std::atomic<uint64_t> errors_{0};
+
+    static LoginRateLimiter &instance()
+    {
+      static LoginRateLimiter instance;
+      return instance;
+    }
+
+    static Decision reject(std::chrono::milliseconds wait)
+    {
+      auto seconds = std::chrono::duration_cast<std::chrono::seconds>(wait + std::chrono::milliseconds(999));
+      return {false, std::max<int>(1, static_cast<int>(seconds.count()))};
+    }
+
+    Shard &shardFor(const std::string &key)
+    {
+      return shards_[std::hash<std::string>{}(key) % SHARDS];
+    }
+
+    TakeResult takeLocal(const std::string &key, Clock::time_point now)
+    {
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      auto it = shard.entries.find(key);
+      if (it == shard.entries.end())
+      {
+        return {};
+      }
+
+      auto &state = it->second;
+      if (state.blockedUntil > now)
+      {
+        return {false, std::chrono::duration_cast<std::chrono::milliseconds>(state.blockedUntil - now)};
+      }
+      if (state.tokens > 0 && state.leaseExpiresAt > now)
+      {
+        state.tokens--;
+        return {true};
+      }
+      shard.entries.erase(it);
+      return {};
+    }
+
+    // Return locally taken tokens when another bucket rejects the attempt
+    void refund(const std::vector<Bucket> &buckets, Clock::time_point now)
+    {
+      for (const auto &bucket : buckets)
+      {
+        if (!bucket.leased)
+        {
+          continue;
+        }
+        auto &shard = shardFor(bucket.key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.entries.find(bucket.key);
+        if (it != shard.entries.end() && it->second.leaseExpiresAt > now)
+        {
+          it->second.tokens++;
+        }
+      }
+    }
+
+    void lease(const std::string &key, int tokens, Clock::time_point expiresAt)
+    {
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      prune(shard);
+      auto &state = shard.entries[key];
+      state.tokens = tokens;
+      state.leaseExpiresAt = expiresAt;
+    }
+
+    void block(const std::string &key, Clock::time_point until)
+    {
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      prune(shard);
+      auto &state = shard.entries[key];
+      state.tokens = 0;
+      state.blockedUntil = until;
+    }
+
+    // Keeps a flood of distinct keys from growing the local state without bound
+    static void prune(Shard &shard)
+    {
+      if (shard.entries.size() < MAX_KEYS_PER_SHARD)
+      {
+        return;
+      }
+
+      auto now = Clock::now();
+      for (auto it = shard.entries.begin(); it != shard.entries.end();)
+      {
+        bool live = it->second.blockedUntil > now || (it->second.tokens > 0 && it->second.leaseExpiresAt > now);
+        it = live ? std::next(it) : shard.entries.erase(it);
+      }
+      if (shard.entries.size() >= MAX_KEYS_PER_SHARD)
+      {
+        shard.entries.clear();
+      }
+    }
+
+    std::vector<long long> evaluate(const std::vector<Bucket *> &buckets, int maxLease)
+    {
+      std::vector<std::string> keys;
+      std::vector<std::string> args;
+      for (const auto *bucket : buckets)
+      {
+        // Lease about a quarter of the burst, so tight per-email buckets are
+        // not parked on one node
+        int want = std::clamp(bucket->burst / 4, 1, std::max(1, maxLease));
+        keys.push_back(bucket->key);
+        args.push_back(std::to_string(bucket->perMinute));
+        args.push_back(std::to_string(bucket->burst));
+        args.push_back(std::to_string(want));
+      }
+
+      redisCalls_++;
+      return take_.eval<std::vector<long long>>(*redis(), keys, args);
+    }
+
+    Redis *redis()
+    {
+      return RedisManager().getRedis();
+    }
+  };
+}
@@ -0,0 +1,241 @@
+#pragma once
+#include <sw/redis++/redis++.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../cache/LruCache.hpp"
+#include "../config/config.hpp"
+#include "../redis/RedisManager.hpp"
+#include "../utils/BloomFilter.hpp"
+#include "../utils/HashUtils.hpp"
+
+namespace Auth
+{
+  // Revoked JWTs, identified by the SHA-256 of the token (TokenCache::key).
+  //
+  // Redis holds the list as a sorted set scored by each token's exp, and
+  // every node mirrors it into a local Bloom filter kept current through
+  // CHANNEL. A token the filter has never seen is known to be live without
+  // leaving the process; only filter positives are confirmed against Redis,
+  // and those answers are cached until the token expires.
+  class RevocationList
+  {
+  public:
+    static constexpr const char *KEY = "jwt:revoked";
+    static constexpr const char *CHANNEL = "jwt-revoke";
+
+    static bool isRevoked(const std::string &tokenKey)
+    {
+      auto &list = instance();
+      list.checks_++;
+      if (!std::atomic_load(&list.filter_)->mightContain(tokenKey))
+      {
+        return false;
+      }
+
+      list.positives_++;
+      if (auto known = list.decisions_.get(tokenKey))
+      {
+        return *known;
+      }
+
+      try
+      {
+        list.redisChecks_++;
+        auto exp = list.redis()->zscore(KEY, toHex(tokenKey));
+        bool revoked = exp && *exp > nowSeconds();
+        if (!revoked)
+        {
+          list.falsePositives_++;
+        }
+        list.decisions_.put(tokenKey, revoked, revoked ? untilExpiry(*exp) : NEGATIVE_TTL);
+        return revoked;
+      }
+      catch (const sw::redis::Error &e)
+      {
+        // Only filter positives get here, so failing closed affects few live tokens
+        list.errors_++;
+        std::cerr << "[RevocationList] Redis check failed, treating token as revoked: " << e.what() << std::endl;
+        return true;
+      }
+    }
+
+    // Revoke until expiresAt on every node; throws sw::redis::Error
+    static void revoke(const std::string &tokenKey, std::chrono::system_clock::time_point expiresAt)
+    {
+      auto &list = instance();
+      // Tokens without exp stay listed for the lifetime we issue
+      auto latest = std::chrono::system_clock::now() + std::chrono::seconds(Config::AppConfig::getAccessTokenTTLSeconds());
+      double exp = static_cast<double>(std::chrono::duration_cast<std::chrono::seconds>(
+                                           std::min(expiresAt, latest).time_since_epoch())
+                                           .count());
+      auto id = toHex(tokenKey);
+
+      auto *redis = list.redis();
+      redis->zadd(KEY, id, exp);
+      redis->publish(CHANNEL, nlohmann::json({{"id", id}, {"exp", exp}}).dump());
+
+      list.remember(tokenKey, exp);
+      list.revocations_++;
+    }
+
+    // Rebuild the filter from Redis, dropping expired entries. Run at startup
+    // and on every (re)subscription to CHANNEL, so revocations published while
+    // the subscriber was down are not missed.
+    static bool load()
+    {
+      auto &list = instance();
+      try
+      {
+        auto *redis = list.redis();
+        double now = nowSeconds();
+        redis->zremrangebyscore(KEY, sw::redis::RightBoundedInterval<double>(now, sw::redis::BoundType::RIGHT_OPEN));
+
+        std::vector<std::string> ids;
+        redis->zrangebyscore(KEY, sw::redis::LeftBoundedInterval<double>(now, sw::redis::BoundType::LEFT_OPEN),
+                             std::back_inserter(ids));
+
+        // Headroom so the filter is not full again right away
+        size_t capacity = std::max<size_t>(Config::AppConfig::getJWTRevocationCapacity(), 2 * ids.size());
+        auto filter = std::make_shared<BloomFilter>(capacity);
+        std::string key(HashUtils::SHA256_BYTES, '\0');
+        for (const auto &id : ids)
+        {
+          if (HashUtils::fromHex(id, reinterpret_cast<unsigned char *>(key.data()), key.size()))
+          {
+            filter->add(key);
+          }
+        }
+
+        std::atomic_store(&list.filter_, filter);
+        list.capacity_.store(capacity);
+        list.loads_++;
+        return true;
+      }
+      catch (const sw::redis::Error &e)
+      {
+        list.errors_++;
+        std::cerr << "[RevocationList] Load failed: " << e.what() << std::endl;
+        return false;
+      }
+    }
+
+    // Called for messages on CHANNEL, including this node's own
+    static void handleMessage(const std::string &payload)
+    {
+      auto &list = instance();
+      try
+      {
+        auto message = nlohmann::json::parse(payload);
+        std::string key(HashUtils::SHA256_BYTES, '\0');
+        if (!HashUtils::fromHex(message.at("id").get<std::string>(), reinterpret_cast<unsigned char *>(key.data()), key.size()))
+        {
+          throw std::invalid_argument("id is not a SHA-256 hex digest");
+        }
+        list.remember(key, message.at("exp").get<double>());
+      }
+      catch (const std::exception &e)
+      {
+        std::cerr << "[RevocationList] Bad revocation message: " << e.what() << std::endl;
+        return;
+      }
+
+      // Entries are never removed, so rebuild once the filter is past its sizing
+      if (std::atomic_load(&list.filter_)->entries() > list.capacity_.load())
+      {
+        load();
+      }
+    }
+
+    static nlohmann::json stats()
+    {
+      auto &list = instance();
+      auto filter = std::atomic_load(&list.filter_);
+      return {{"checks", list.checks_.load()},
+              {"filter_positives", list.positives_.load()},
+              {"redis_checks", list.redisChecks_.load()},
+              {"false_positives", list.falsePositives_.load()},
+              {"revocations", list.revocations_.load()},
+              {"loads", list.loads_.load()},
+              {"errors", list.errors_.load()},
+              {"filter", {{"bits", filter->bits()},
+                          {"hashes", filter->hashes()},
+                          {"entries", filter->entries()},
+                          {"capacity", list.capacity_.load()},
+                          {"estimated_fp_rate", filter->estimatedFalsePositiveRate()}}}};
+    }
+
+  private:
+    static constexpr size_t DECISION_SHARDS = 16;
+    static constexpr size_t DECISION_MAX_BYTES = 1024 * 1024;
+    // How long a confirmed false positive is trusted before asking Redis again
+    static constexpr auto NEGATIVE_TTL = std::chrono::seconds(10);
+
+    std::shared_ptr<BloomFilter> filter_;
+    std::atomic<size_t> capacity_;
+    Cache::ShardedLruCache<std::string, bool> decisions_;
+
+    std::atomic<uint64_t> checks_{0};
+    std::atomic<uint64_t> positives_{0};
+    std::atomic<uint64_t> redisChecks_{0};
+    std::atomic<uint64_t> falsePositives_{0};
+    std::atomic<uint64_t> revocations_{0};
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> errors_{0};
+
+    RevocationList()
+        : filter_(std::make_shared<BloomFilter>(Config::AppConfig::getJWTRevocationCapacity())),
+          capacity_(Config::AppConfig::getJWTRevocationCapacity()),
+          decisions_(DECISION_MAX_BYTES, DECISION_SHARDS,
+                     [](const std::string &key, const bool &)
+                     { return key.capacity() + 64; })
+    {
+    }
+
+    static RevocationList &instance()
+    {
+      static RevocationList instance;
+      return instance;
+    }
+
+    void remember(const std::string &tokenKey, double exp)
+    {
+      std::atomic_load(&filter_)->add(tokenKey);
+      auto ttl = untilExpiry(exp);
+      if (ttl.count() > 0)
+      {
+        decisions_.put(tokenKey, true, ttl);
+      }
+    }
+
+    static double nowSeconds()
+    {
+      return static_cast<double>(std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+    }
+
+    static std::chrono::milliseconds untilExpiry(double exp)
+    {
+      return std::chrono::milliseconds(static_cast<int64_t>((exp - nowSeconds()) * 1000));
+    }
+
+    static std::string toHex(const std::string &tokenKey)
+    {
+      std::string hex(2 * tokenKey.size(), '\0');
+      HashUtils::toHex(reinterpret_cast<const unsigned char *>(tokenKey.data()), tokenKey.size(), hex.data());
+      return hex;
+    }
+
+    Redis *redis()
+    {
+      return RedisManager().getRedis();
+    }
+  };
+}
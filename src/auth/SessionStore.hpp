@@ -0,0 +1,234 @@
+#pragma once
+#include <sw/redis++/redis++.h>
+#include <nlohmann/json.hpp>
+#include <openssl/rand.h>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../config/config.hpp"
+#include "../redis/RedisManager.hpp"
+#include "../redis/RedisScript.hpp"
+#include "../utils/HashUtils.hpp"
+
+namespace Auth
+{
+  // Refresh-token sessions in Redis. A refresh token is "<session id>.<secret>";
+  // the session key holds only the SHA-256 of the current and the previous
+  // secret followed by the claims the access token needs, so refreshing never
+  // touches MySQL:
+  //
+  //   session:<id> -> <current digest><previous digest><user id>\n<email>   (EX = refresh TTL)
+  //   sessions:user:<user id> -> set of session ids
+  //
+  // Every refresh rotates the secret. Presenting the secret just superseded
+  // means the token was copied, so the whole session is ended; any other wrong
+  // secret is only rejected, so guessing cannot log a user out.
+  class SessionStore
+  {
+  public:
+    struct Session
+    {
+      std::string id;
+      int64_t userId = 0;
+      std::string email;
+    };
+
+    enum class RotateStatus
+    {
+      Rotated,
+      Unknown, // Malformed, expired, ended or a wrong secret
+      Reused   // The superseded secret; the session has been ended
+    };
+
+    struct Rotation
+    {
+      RotateStatus status = RotateStatus::Unknown;
+      Session session;
+      std::string refreshToken;
+    };
+
+    // Start a session and return its first refresh token; throws sw::redis::Error
+    static std::string create(int64_t userId, const std::string &email)
+    {
+      auto &store = instance();
+      auto id = randomHex(ID_BYTES);
+      auto secret = randomHex(SECRET_BYTES);
+      auto ttl = std::to_string(Config::AppConfig::getRefreshTokenTTLSeconds());
+      // No previous secret yet: zero bytes, which no secret hashes to
+      std::string previous(HashUtils::SHA256_BYTES, '\0');
+
+      store.createScript_.eval<long long>(*store.redis(), {sessionKey(id), userKey(userId)},
+                                          {digest(secret) + previous + std::to_string(userId) + "\n" + email, ttl, id});
+      store.created_++;
+      return id + "." + secret;
+    }
+
+    // Swap a refresh token for its successor; throws sw::redis::Error
+    static Rotation rotate(const std::string &refreshToken)
+    {
+      auto &store = instance();
+      Rotation rotation;
+      auto dot = refreshToken.find('.');
+      if (dot != 2 * ID_BYTES || refreshToken.size() != dot + 1 + 2 * SECRET_BYTES)
+      {
+        store.unknown_++;
+        return rotation;
+      }
+
+      auto id = refreshToken.substr(0, dot);
+      auto secret = refreshToken.substr(dot + 1);
+      auto next = randomHex(SECRET_BYTES);
+      auto ttl = std::to_string(Config::AppConfig::getRefreshTokenTTLSeconds());
+
+      auto reply = store.rotateScript_.eval<std::vector<std::string>>(*store.redis(), {sessionKey(id)},
+                                                                      {digest(secret), digest(next), ttl});
+      if (reply.empty() || reply[0] == "unknown")
+      {
+        store.unknown_++;
+        return rotation;
+      }
+      if (reply[0] == "reused")
+      {
+        store.reused_++;
+        rotation.status = RotateStatus::Reused;
+        return rotation;
+      }
+
+      // "<user id>\n<email>"
+      const auto &claims = reply.at(1);
+      auto newline = claims.find('\n');
+      rotation.status = RotateStatus::Rotated;
+      rotation.session.id = id;
+      rotation.session.userId = std::stoll(claims.substr(0, newline));
+      rotation.session.email = newline == std::string::npos ? "" : claims.substr(newline + 1);
+      rotation.refreshToken = id + "." + next;
+      store.rotated_++;
+      return rotation;
+    }
+
+    // End one session, e.g. on logout; throws sw::redis::Error
+    static void end(const std::string &sessionId)
+    {
+      auto &store = instance();
+      store.redis()->del(sessionKey(sessionId));
+      store.ended_++;
+    }
+
+    // End every session of a user, e.g. when the account is deleted
+    static void endAll(int64_t userId)
+    {
+      auto &store = instance();
+      auto ended = store.endAllScript_.eval<long long>(*store.redis(), {userKey(userId)}, {SESSION_PREFIX});
+      store.ended_ += static_cast<uint64_t>(ended);
+    }
+
+    static nlohmann::json stats()
+    {
+      auto &store = instance();
+      return {{"created", store.created_.load()},
+              {"rotated", store.rotated_.load()},
+              {"unknown", store.unknown_.load()},
+              {"reused", store.reused_.load()},
+              {"ended", store.ended_.load()}};
+    }
+
+  private:
+    static constexpr size_t ID_BYTES = 16;
+    static constexpr size_t SECRET_BYTES = 32;
+    static constexpr const char *SESSION_PREFIX = "session:";
+
+    // KEYS: session, user index. ARGV: value, ttl, session id
+    static constexpr const char *CREATE_SOURCE = R"lua(
+local ttl = tonumber(ARGV[2])
+redis.call('SET', KEYS[1], ARGV[1], 'EX', ttl)
+redis.call('SADD', KEYS[2], ARGV[3])
+if redis.call('TTL', KEYS[2]) < ttl then
+  redis.call('EXPIRE', KEYS[2], ttl)
+end
+return 1
+)lua";
+
+    // KEYS: session. ARGV: presented digest, next digest, ttl
+    static constexpr const char *ROTATE_SOURCE = R"lua(
+local value = redis.call('GET', KEYS[1])
+if not value then
+  return {'unknown'}
+end
+local current = string.sub(value, 1, 32)
+if current ~= ARGV[1] then
+  if string.sub(value, 33, 64) == ARGV[1] then
+    redis.call('DEL', KEYS[1])
+    return {'reused'}
+  end
+  return {'unknown'}
+end
+local claims = string.sub(value, 65)
+redis.call('SET', KEYS[1], ARGV[2] .. current .. claims, 'EX', tonumber(ARGV[3]))
+return {'rotated', claims}
+)lua";
+
+    // KEYS: user index. ARGV: session key prefix
+    static constexpr const char *END_ALL_SOURCE = R"lua(
+local ids = redis.call('SMEMBERS', KEYS[1])
+for _, id in ipairs(ids) do
+  redis.call('DEL', ARGV[1] .. id)
+end
+redis.call('DEL', KEYS[1])
+return #ids
+)lua";
+
+    RedisScript createScript_{CREATE_SOURCE};
+    RedisScript rotateScript_{ROTATE_SOURCE};
+    RedisScript endAllScript_{END_ALL_SOURCE};
+
+    std::atomic<uint64_t> created_{0};
+    std::atomic<uint64_t> rotated_{0};
+    std::atomic<uint64_t> unknown_{0};
+    std::atomic<uint64_t> reused_{0};
+    std::atomic<uint64_t> ended_{0};
+
+    static SessionStore &instance()
+    {
+      static SessionStore instance;
+      return instance;
+    }
+
+    static std::string sessionKey(const std::string &id)
+    {
+      return SESSION_PREFIX + id;
+    }
+
+    static std::string userKey(int64_t userId)
+    {
+      return "sessions:user:" + std::to_string(userId);
+    }
+
+    // Raw SHA-256, so a Redis dump holds no usable refresh tokens
+    static std::string digest(const std::string &secret)
+    {
+      std::string out(HashUtils::SHA256_BYTES, '\0');
+      HashUtils::sha256(secret.data(), secret.size(), reinterpret_cast<unsigned char *>(out.data()));
+      return out;
+    }
+
+    static std::string randomHex(size_t bytes)
+    {
+      std::vector<unsigned char> random(bytes);
+      if (RAND_bytes(random.data(), static_cast<int>(bytes)) != 1)
+      {
+        throw std::runtime_error("RAND_bytes failed");
+      }
+      std::string hex(2 * bytes, '\0');
+      HashUtils::toHex(random.data(), bytes, hex.data());
+      return hex;
+    }
+
+    Redis *redis()
+    {
+      return RedisManager().getRedis();
+    }
+  };
+}
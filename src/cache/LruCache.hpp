@@ -0,0 +1,175 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Cache
+{
+  // In-process LRU cache split into independently locked shards so that
+  // concurrent Crow workers rarely contend on the same mutex. Each entry
+  // has its own expiry, and every shard evicts least recently used entries
+  // to stay within its share of the byte budget.
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class ShardedLruCache
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Sizer = std::function<size_t(const Key &, const Value &)>;
+
+    ShardedLruCache(size_t maxBytes, size_t shardCount, Sizer sizer)
+        : shards_(std::max<size_t>(1, shardCount)), sizer_(std::move(sizer))
+    {
+      shardBudget_ = std::max<size_t>(1, maxBytes / shards_.size());
+    }
+
+    std::optional<Value> get(const Key &key)
+    {
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+
+      auto it = shard.index.find(key);
+      if (it == shard.index.end())
+      {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+
+      if (it->second->expiresAt <= Clock::now())
+      {
+        removeLocked(shard, it->second);
+        expirations_.fetch_add(1, std::memory_order_relaxed);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+
+      // Move to the front: most recently used
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second->value;
+    }
+
+    void put(const Key &key, Value value, std::chrono::milliseconds ttl)
+    {
+      size_t bytes = sizer_(key, value);
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+
+      auto existing = shard.index.find(key);
+      if (existing != shard.index.end())
+      {
+        removeLocked(shard, existing->second);
+      }
+
+      if (bytes > shardBudget_)
+      {
+        return; // Would evict the whole shard for one entry
+      }
+
+      shard.entries.push_front({key, std::move(value), Clock::now() + ttl, bytes});
+      shard.index[key] = shard.entries.begin();
+      shard.bytes += bytes;
+
+      while (shard.bytes > shardBudget_ && !shard.entries.empty())
+      {
+        removeLocked(shard, std::prev(shard.entries.end()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    void erase(const Key &key)
+    {
+      auto &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+
+      auto it = shard.index.find(key);
+      if (it != shard.index.end())
+      {
+        removeLocked(shard, it->second);
+      }
+    }
+
+    void clear()
+    {
+      for (auto &shard : shards_)
+      {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        shard.entries.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+      }
+    }
+
+    nlohmann::json stats()
+    {
+      size_t entries = 0;
+      size_t bytes = 0;
+      for (auto &shard : shards_)
+      {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        entries += shard.entries.size();
+        bytes += shard.bytes;
+      }
+
+      return {{"entries", entries},
+              {"bytes", bytes},
+              {"max_bytes", shardBudget_ * shards_.size()},
+              {"hits", hits_.load()},
+              {"misses", misses_.load()},
+              {"evictions", evictions_.load()},
+              {"expirations", expirations_.load()}};
+    }
+
+  private:
+    struct Entry
+    {
+      Key key;
+      Value value;
+      Clock::time_point expiresAt;
+      size_t bytes;
+    };
+
+    struct Shard
+    {
+      std::mutex mtx;
+      std::list<Entry> entries;
+      std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+      size_t bytes = 0;
+    };
+
+    std::vector<Shard> shards_;
+    size_t shardBudget_;
+    Sizer sizer_;
+    Hash hash_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+
+    Shard &shardFor(const Key &key)
+    {
+      // Mix the hash so keys that differ only in low bits spread across shards
+      size_t h = hash_(key);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      return shards_[h % shards_.size()];
+    }
+
+    void removeLocked(Shard &shard, typename std::list<Entry>::iterator it)
+    {
+      shard.bytes -= it->bytes;
+      shard.index.erase(it->key);
+      shard.entries.erase(it);
+    }
+  };
+}
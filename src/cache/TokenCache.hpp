@@ -0,0 +1,137 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include "LruCache.hpp"
+#include "../config/config.hpp"
+#include "../models/Identity.hpp"
+#include "../utils/HashUtils.hpp"
+
+namespace Cache
+{
+  // Remembers verified JWTs so a token presented again skips decoding and
+  // the HMAC check until it expires. Entries are keyed by the SHA-256 of
+  // the token, never the token itself, and belong to the keys that verified
+  // them (the secret argument, KeySet::fingerprint): different keys flush
+  // the whole cache.
+  //
+  // The static functions use the process-wide cache; tests construct their own.
+  class TokenCache
+  {
+  public:
+    explicit TokenCache(size_t maxBytes)
+        : entries_(maxBytes, SHARDS,
+                   [](const std::string &key, const Identity &identity)
+                   { return key.capacity() + sizeof(Identity) + identity.email.capacity() + identity.sessionId.capacity() + 64; })
+    {
+    }
+
+    TokenCache(const TokenCache &) = delete;
+    TokenCache &operator=(const TokenCache &) = delete;
+
+    // Raw 32-byte digest of a token, which also identifies it for revocation;
+    // cheaper to hash and compare than the token itself
+    static std::string key(const std::string &token)
+    {
+      std::string digest(HashUtils::SHA256_BYTES, '\0');
+      HashUtils::sha256(token.data(), token.size(), reinterpret_cast<unsigned char *>(digest.data()));
+      return digest;
+    }
+
+    // tokenKey is key(token), computed once per request by the caller
+    static std::optional<Identity> get(const std::string &tokenKey, const std::string &secret)
+    {
+      return instance().lookup(tokenKey, secret);
+    }
+
+    static void put(const std::string &tokenKey, const std::string &secret, const Identity &identity)
+    {
+      instance().store(tokenKey, secret, identity);
+    }
+
+    std::optional<Identity> lookup(const std::string &tokenKey, const std::string &secret)
+    {
+      checkSecret(secret);
+
+      auto entry = entries_.get(tokenKey);
+      // The LRU expires on the steady clock; exp is wall-clock time
+      if (entry && entry->expiresAt <= std::chrono::system_clock::now())
+      {
+        entries_.erase(tokenKey);
+        return std::nullopt;
+      }
+      return entry;
+    }
+
+    void store(const std::string &tokenKey, const std::string &secret, const Identity &identity)
+    {
+      checkSecret(secret);
+
+      auto ttl = std::chrono::duration_cast<std::chrono::milliseconds>(identity.expiresAt - std::chrono::system_clock::now());
+      ttl = std::min<std::chrono::milliseconds>(ttl, std::chrono::seconds(Config::AppConfig::getJWTCacheMaxTTLSeconds()));
+      if (ttl.count() <= 0)
+      {
+        return;
+      }
+      entries_.put(tokenKey, identity, ttl);
+    }
+
+    // Drop every entry, e.g. after the signing keys change
+    static void flush()
+    {
+      auto &cache = instance();
+      cache.entries_.clear();
+      cache.flushes_++;
+    }
+
+    static nlohmann::json stats()
+    {
+      auto &cache = instance();
+      auto stats = cache.entries_.stats();
+      auto hits = stats["hits"].get<uint64_t>();
+      auto lookups = hits + stats["misses"].get<uint64_t>();
+      stats["hit_rate"] = lookups ? static_cast<double>(hits) / lookups : 0.0;
+      stats["flushes"] = cache.flushes_.load();
+      return stats;
+    }
+
+  private:
+    static constexpr size_t SHARDS = 16;
+
+    ShardedLruCache<std::string, Identity> entries_;
+    std::atomic<size_t> secretHash_{0};
+    std::mutex secretMtx_;
+    std::atomic<uint64_t> flushes_{0};
+
+    static TokenCache &instance()
+    {
+      static TokenCache instance(Config::AppConfig::getJWTCacheMaxBytes());
+      return instance;
+    }
+
+    void checkSecret(const std::string &secret)
+    {
+      size_t hash = std::hash<std::string>{}(secret);
+      if (secretHash_.load(std::memory_order_acquire) == hash)
+      {
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(secretMtx_);
+      if (secretHash_.load(std::memory_order_relaxed) != hash)
+      {
+        entries_.clear();
+        // The first secret seen is not a rotation
+        if (secretHash_.exchange(hash, std::memory_order_release) != 0)
+        {
+          flushes_++;
+        }
+      }
+    }
+  };
+}
@@ -0,0 +1,319 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "LruCache.hpp"
+#include "../config/config.hpp"
+#include "../models/User.hpp"
+#include "../redis/RedisBatch.hpp"
+#include "../redis/RedisGetBatcher.hpp"
+#include "../utils/StringUtils.hpp"
+
+namespace Cache
+{
+  using json = nlohmann::json;
+
+  // Two-level read-through cache for User rows, keyed by id and by email:
+  // a sharded in-process LRU (L1) in front of Redis (L2) in front of MySQL.
+  // Writes delete both keys and announce the change on INVALIDATION_CHANNEL
+  // so other API nodes drop their L1 copies. Email keys are lowercased, so
+  // lookups and invalidations that differ only in case share one entry.
+  class UserCache
+  {
+  public:
+    static constexpr const char *INVALIDATION_CHANNEL = "user-invalidate";
+    // Bump when the cached layout changes; older entries count as stale
+    static constexpr int ENTRY_VERSION = 1;
+
+    using InvalidationListener = std::function<void(int64_t id, const std::string &email)>;
+
+    template <typename Loader>
+    static std::optional<User> getById(int64_t id, Loader &&load)
+    {
+      auto &cache = instance();
+      if (auto user = cache.localById_.get(id))
+      {
+        return user;
+      }
+
+      auto user = readThrough(idKey(id), std::forward<Loader>(load));
+      if (user)
+      {
+        cache.remember(*user);
+      }
+      return user;
+    }
+
+    template <typename Loader>
+    static std::optional<User> getByEmail(const std::string &email, Loader &&load)
+    {
+      auto &cache = instance();
+      if (auto user = cache.localByEmail_.get(StringUtils::toLower(email)))
+      {
+        return user;
+      }
+
+      auto user = readThrough(emailKey(email), std::forward<Loader>(load));
+      if (user)
+      {
+        cache.remember(*user);
+      }
+      return user;
+    }
+
+    // Email of the cached entry for id, if any, found without querying MySQL.
+    // Writers that do not read the row first use it to drop the by-email key.
+    static std::optional<std::string> cachedEmail(int64_t id)
+    {
+      auto &cache = instance();
+      if (auto user = cache.localById_.get(id))
+      {
+        return user->email;
+      }
+
+      try
+      {
+        if (auto cached = RedisGetBatcher::get(idKey(id)))
+        {
+          auto entry = json::parse(*cached, nullptr, false);
+          if (!entry.is_discarded())
+          {
+            if (auto user = fromJson(entry))
+            {
+              return user->email;
+            }
+          }
+        }
+      }
+      catch (const std::exception &e)
+      {
+        cache.errors_++;
+      }
+      return std::nullopt;
+    }
+
+    // Drop a user's entries here and on every other node. An empty email
+    // drops only the by-id entry.
+    static void invalidate(int64_t id, const std::string &email)
+    {
+      auto &cache = instance();
+      cache.invalidations_++;
+      notifyListeners(id, email);
+
+      try
+      {
+        // Deletes and announcement share one round trip
+        RedisBatch batch;
+        batch.del(idKey(id));
+        if (!email.empty())
+        {
+          batch.del(emailKey(email));
+        }
+        json message = {{"node", cache.nodeId_}, {"id", id}, {"email", email}};
+        batch.publish(INVALIDATION_CHANNEL, message.dump());
+        batch.flush();
+      }
+      catch (const sw::redis::Error &e)
+      {
+        cache.errors_++;
+        std::cerr << "[UserCache] Invalidation failed: " << e.what() << std::endl;
+      }
+    }
+
+    // Called for messages on INVALIDATION_CHANNEL
+    static void handleInvalidationMessage(const std::string &payload)
+    {
+      try
+      {
+        auto message = json::parse(payload);
+        if (message.value("node", "") == instance().nodeId_)
+        {
+          return; // Already handled when this node published it
+        }
+        notifyListeners(message.at("id").get<int64_t>(), message.value("email", ""));
+      }
+      catch (const std::exception &e)
+      {
+        std::cerr << "[UserCache] Bad invalidation message: " << e.what() << std::endl;
+      }
+    }
+
+    // Register a hook for local copies (in-process caches) to drop entries
+    static void onInvalidate(InvalidationListener listener)
+    {
+      auto &cache = instance();
+      std::lock_guard<std::mutex> lock(cache.listenersMtx_);
+      cache.listeners_.push_back(std::move(listener));
+    }
+
+    static json stats()
+    {
+      auto &cache = instance();
+      return {{"hits", cache.hits_.load()},
+              {"misses", cache.misses_.load()},
+              {"stale", cache.stale_.load()},
+              {"errors", cache.errors_.load()},
+              {"invalidations", cache.invalidations_.load()},
+              {"l2_get_batching", RedisGetBatcher::stats()},
+              {"l1", {{"by_id", cache.localById_.stats()}, {"by_email", cache.localByEmail_.stats()}}}};
+    }
+
+    static json toJson(const User &user)
+    {
+      return {{"v", ENTRY_VERSION},
+              {"id", user.id},
+              {"name", user.name},
+              {"email", user.email},
+              {"password", user.password}};
+    }
+
+    // Returns nullopt for entries written with another ENTRY_VERSION
+    static std::optional<User> fromJson(const json &entry)
+    {
+      if (entry.value("v", 0) != ENTRY_VERSION)
+      {
+        return std::nullopt;
+      }
+
+      User user;
+      user.id = entry.at("id").get<int64_t>();
+      user.name = entry.at("name").get<std::string>();
+      user.email = entry.at("email").get<std::string>();
+      user.password = entry.at("password").get<std::string>();
+      return user;
+    }
+
+  private:
+    static constexpr size_t L1_SHARDS = 16;
+
+    ShardedLruCache<int64_t, User> localById_;
+    ShardedLruCache<std::string, User> localByEmail_;
+    std::chrono::milliseconds localTTL_;
+    std::string nodeId_ = StringUtils::generateUUID();
+    std::vector<InvalidationListener> listeners_;
+    std::mutex listenersMtx_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> invalidations_{0};
+
+    UserCache()
+        : localById_(Config::AppConfig::getUserL1MaxBytes() / 2, L1_SHARDS,
+                     [](const int64_t &, const User &user)
+                     { return entrySize(user); }),
+          localByEmail_(Config::AppConfig::getUserL1MaxBytes() / 2, L1_SHARDS,
+                        [](const std::string &email, const User &user)
+                        { return email.capacity() + entrySize(user); }),
+          localTTL_(std::chrono::seconds(Config::AppConfig::getUserL1TTLSeconds()))
+    {
+      // Local and remote invalidations both drop the L1 copies
+      listeners_.push_back([this](int64_t id, const std::string &email)
+                           {
+        localById_.erase(id);
+        localByEmail_.erase(StringUtils::toLower(email)); });
+    }
+
+    static UserCache &instance()
+    {
+      static UserCache instance;
+      return instance;
+    }
+
+    // Approximate heap footprint of a cached User, including list and map nodes
+    static size_t entrySize(const User &user)
+    {
+      return sizeof(User) + user.name.capacity() + user.email.capacity() + user.password.capacity() + 64;
+    }
+
+    void remember(const User &user)
+    {
+      localById_.put(user.id, user, localTTL_);
+      localByEmail_.put(StringUtils::toLower(user.email), user, localTTL_);
+    }
+
+    static std::string idKey(int64_t id)
+    {
+      return "user:id:" + std::to_string(id);
+    }
+
+    static std::string emailKey(const std::string &email)
+    {
+      return "user:email:" + StringUtils::toLower(email);
+    }
+
+    static void notifyListeners(int64_t id, const std::string &email)
+    {
+      auto &cache = instance();
+      std::lock_guard<std::mutex> lock(cache.listenersMtx_);
+      for (const auto &listener : cache.listeners_)
+      {
+        listener(id, email);
+      }
+    }
+
+    // Redis failures fall back to the loader so the cache never fails a request
+    template <typename Loader>
+    static std::optional<User> readThrough(const std::string &key, Loader &&load)
+    {
+      auto &cache = instance();
+
+      try
+      {
+        auto cached = RedisGetBatcher::get(key);
+        if (cached)
+        {
+          auto entry = json::parse(*cached, nullptr, false);
+          if (!entry.is_discarded())
+          {
+            if (auto user = fromJson(entry))
+            {
+              cache.hits_++;
+              return user;
+            }
+          }
+          cache.stale_++;
+        }
+        else
+        {
+          cache.misses_++;
+        }
+      }
+      catch (const std::exception &e)
+      {
+        cache.errors_++;
+      }
+
+      std::optional<User> user = load();
+      if (user)
+      {
+        store(*user);
+      }
+      return user;
+    }
+
+    static void store(const User &user)
+    {
+      auto &cache = instance();
+      try
+      {
+        auto ttl = std::chrono::seconds(Config::AppConfig::getUserCacheTTLSeconds());
+        auto payload = toJson(user).dump();
+        RedisBatch batch;
+        batch.set(idKey(user.id), payload, ttl).set(emailKey(user.email), payload, ttl);
+        batch.flush();
+      }
+      catch (const sw::redis::Error &e)
+      {
+        cache.errors_++;
+      }
+    }
+  };
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <pthread.h>
+#include <signal.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include "config.hpp"
+
+namespace Config
+{
+  // Reloads AppConfig when the process receives SIGHUP. The signal is
+  // blocked in every thread and consumed with sigwait on a dedicated one,
+  // so the reload runs as ordinary code rather than inside a signal handler.
+  class ReloadSignal
+  {
+  public:
+    // Must run before any other thread starts so they all inherit the mask
+    static void block()
+    {
+      sigset_t set = signals();
+      pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    }
+
+    ReloadSignal() = default;
+    ReloadSignal(const ReloadSignal &) = delete;
+    ReloadSignal &operator=(const ReloadSignal &) = delete;
+
+    void start()
+    {
+      if (!running_.exchange(true))
+      {
+        worker_ = std::thread(&ReloadSignal::run, this);
+      }
+    }
+
+    void stop()
+    {
+      if (running_.exchange(false) && worker_.joinable())
+      {
+        // Wake sigwait; the loop sees running_ is false and exits
+        pthread_kill(worker_.native_handle(), SIGHUP);
+        worker_.join();
+      }
+    }
+
+    ~ReloadSignal()
+    {
+      stop();
+    }
+
+  private:
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+
+    static sigset_t signals()
+    {
+      sigset_t set;
+      sigemptyset(&set);
+      sigaddset(&set, SIGHUP);
+      return set;
+    }
+
+    void run()
+    {
+      sigset_t set = signals();
+      while (running_.load())
+      {
+        int signal = 0;
+        if (sigwait(&set, &signal) != 0 || !running_.load())
+        {
+          continue;
+        }
+        std::cout << "[Config] SIGHUP received, reloading" << std::endl;
+        AppConfig::reload();
+      }
+    }
+  };
+}
@@ -1,63 +1,632 @@
 #pragma once
+#include <atomic>
 #include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace Config
 {
+  // Every setting, parsed and validated once. A snapshot never changes after
+  // it is published; a reload builds a new one and swaps the pointer.
+  struct Settings
+  {
+    std::string mysqlHost;
+    std::string mysqlUser;
+    std::string mysqlPassword;
+    std::string mysqlDatabase;
+    int mysqlPort = 3306;
+
+    // MySQL connection pool
+    int dbPoolMinSize = 2;
+    int dbPoolMaxSize = 16;
+    int dbPoolTimeoutMs = 2000;
+    int dbPoolIdleTimeoutMs = 60000;
+
+    // Worker threads that run database work off the Crow I/O threads
+    int dbExecutorThreads = 8;
+    int dbExecutorQueueSize = 1024;
+
+    // GET /api/users pagination
+    int usersPageSize = 50;
+    int usersMaxPageSize = 500;
+    // Largest array accepted by POST /api/users/bulk
+    int usersBulkMax = 10000;
+
+    int userCacheTTLSeconds = 300;
+    // In-process user cache in front of Redis
+    int userL1TTLSeconds = 30;
+    int userL1MaxBytes = 16 * 1024 * 1024;
+
+    int port = 3000;
+    std::string redisHost;
+    int redisPort = 6379;
+    // Shared Redis connection pool; read once, when the client is first used
+    int redisPoolSize = 16;
+    int redisPoolWaitMs = 100;
+    int redisPoolIdleMs = 60000;
+    int redisTimeoutMs = 200;
+    // Concurrent GETs wait up to this long to share one MGET; 0 disables
+    int redisGetBatchWindowUs = 50;
+    int redisGetBatchMax = 64;
+
+    // Sink for log events; no file means stdout. Read at startup.
+    std::string logFile;
+    int logQueueSize = 65536;
+    int logMaxBytes = 64 * 1024 * 1024;
+    int logMaxFiles = 5;
+    // gzip level for rotated files, 0 to leave them plain
+    int logCompressLevel = 0;
+
+    // Event bus handler pool; read at startup
+    int eventThreads = 4;
+    int eventQueueSize = 1024;
+    // Unhandled messages kept per channel before new ones are dropped
+    int eventChannelPending = 10000;
+    // Redis Streams: approximate MAXLEN, entries per XREADGROUP, and how long
+    // an entry may stay unacknowledged before another consumer claims it
+    int eventStreamMaxLen = 100000;
+    int eventStreamBatch = 100;
+    int eventStreamReclaimIdleMs = 60000;
+
+    std::string jwtSecret;
+    // Directory of <kid>.pem keys for RS256/ES256/EdDSA, and the kid that signs
+    std::string jwtKeysDir;
+    std::string jwtSigningKid;
+    // Access tokens are short-lived; refresh tokens renew them via /api/auth/refresh
+    int accessTokenTTLSeconds = 900;
+    int refreshTokenTTLSeconds = 30 * 24 * 3600;
+    int jwtCacheMaxBytes = 8 * 1024 * 1024;
+    // Upper bound on how long a verified token is trusted without a recheck
+    int jwtCacheMaxTTLSeconds = 3600;
+    // Live revocations the local Bloom filter is sized for (about 1.2 bytes each)
+    int jwtRevocationCapacity = 100000;
+
+    // Password hashing pool and scrypt cost (N = 2^scryptLogN)
+    int passwordHashThreads = 4;
+    int passwordHashQueueSize = 256;
+    int scryptLogN = 15;
+    int scryptR = 8;
+    int scryptP = 1;
+
+    // Login token buckets per client IP and per email; a rate of 0 disables one
+    int loginIpPerMinute = 30;
+    int loginIpBurst = 20;
+    int loginEmailPerMinute = 5;
+    int loginEmailBurst = 5;
+    // Most tokens one Redis call may lease to this process
+    int loginLimitLease = 4;
+
+    // Environment variables, overridden by KEY=VALUE lines in CONFIG_FILE when
+    // it is set. Throws std::invalid_argument naming the offending key.
+    static Settings load()
+    {
+      auto values = readConfigFile();
+      auto text = [&values](const std::string &key)
+      {
+        auto it = values.find(key);
+        if (it != values.end())
+        {
+          return it->second;
+        }
+        const char *val = std::getenv(key.c_str());
+        return val ? std::string(val) : std::string();
+      };
+      auto number = [&text](const std::string &key, int defaultValue, int min, int max)
+      {
+        auto raw = text(key);
+        if (raw.empty())
+        {
+          return defaultValue;
+        }
+
+        size_t used = 0;
+        int value = 0;
+        try
+        {
+          value = std::stoi(raw, &used);
+        }
+        catch (const std::exception &)
+        {
+          used = 0;
+        }
+        if (used != raw.size() || value < min || value > max)
+        {
+          throw std::invalid_argument(key + " must be an integer between " + std::to_string(min) +
+                                      " and " + std::to_string(max) + ", got '" + raw + "'");
+        }
+        return value;
+      };
+
+      constexpr int MAX = 1 << 30;
+      Settings s;
+      s.mysqlHost = text("MYSQL_HOST");
+      s.mysqlUser = text("MYSQL_USER");
+      s.mysqlPassword = text("MYSQL_PASSWORD");
+      s.mysqlDatabase = text("MYSQL_DATABASE");
+      s.mysqlPort = number("MYSQL_PORT", s.mysqlPort, 1, 65535);
+      s.dbPoolMinSize = number("DB_POOL_MIN", s.dbPoolMinSize, 0, 4096);
+      s.dbPoolMaxSize = number("DB_POOL_MAX", s.dbPoolMaxSize, 1, 4096);
+      s.dbPoolTimeoutMs = number("DB_POOL_TIMEOUT_MS", s.dbPoolTimeoutMs, 0, MAX);
+      s.dbPoolIdleTimeoutMs = number("DB_POOL_IDLE_MS", s.dbPoolIdleTimeoutMs, 1, MAX);
+      s.dbExecutorThreads = number("DB_EXECUTOR_THREADS", s.dbExecutorThreads, 1, 1024);
+      s.dbExecutorQueueSize = number("DB_EXECUTOR_QUEUE", s.dbExecutorQueueSize, 1, MAX);
+      s.usersPageSize = number("USERS_PAGE_SIZE", s.usersPageSize, 1, MAX);
+      s.usersMaxPageSize = number("USERS_MAX_PAGE_SIZE", s.usersMaxPageSize, 1, MAX);
+      s.usersBulkMax = number("USERS_BULK_MAX", s.usersBulkMax, 1, MAX);
+      s.userCacheTTLSeconds = number("USER_CACHE_TTL_SECONDS", s.userCacheTTLSeconds, 1, MAX);
+      s.userL1TTLSeconds = number("USER_L1_TTL_SECONDS", s.userL1TTLSeconds, 0, MAX);
+      s.userL1MaxBytes = number("USER_L1_MAX_BYTES", s.userL1MaxBytes, 0, MAX);
+      s.port = number("PORT", s.port, 1, 65535);
+      s.redisHost = text("REDIS_HOST");
+      s.redisPort = number("REDIS_PORT", s.redisPort, 1, 65535);
+      s.redisPoolSize = number("REDIS_POOL_SIZE", s.redisPoolSize, 1, 1024);
+      s.redisPoolWaitMs = number("REDIS_POOL_WAIT_MS", s.redisPoolWaitMs, 0, MAX);
+      s.redisPoolIdleMs = number("REDIS_POOL_IDLE_MS", s.redisPoolIdleMs, 0, MAX);
+      s.redisTimeoutMs = number("REDIS_TIMEOUT_MS", s.redisTimeoutMs, 1, MAX);
+      s.redisGetBatchWindowUs = number("REDIS_GET_BATCH_WINDOW_US", s.redisGetBatchWindowUs, 0, 100000);
+      s.redisGetBatchMax = number("REDIS_GET_BATCH_MAX", s.redisGetBatchMax, 1, 4096);
+      s.logFile = text("LOG_FILE");
+      s.logQueueSize = number("LOG_QUEUE_SIZE", s.logQueueSize, 2, 1 << 24);
+      s.logMaxBytes = number("LOG_MAX_BYTES", s.logMaxBytes, 1024, MAX);
+      s.logMaxFiles = number("LOG_MAX_FILES", s.logMaxFiles, 1, 100);
+      s.logCompressLevel = number("LOG_COMPRESS_LEVEL", s.logCompressLevel, 0, 9);
+      s.eventThreads = number("EVENT_THREADS", s.eventThreads, 1, 256);
+      s.eventQueueSize = number("EVENT_QUEUE", s.eventQueueSize, 1, MAX);
+      s.eventChannelPending = number("EVENT_CHANNEL_PENDING", s.eventChannelPending, 1, MAX);
+      s.eventStreamMaxLen = number("EVENT_STREAM_MAXLEN", s.eventStreamMaxLen, 1, MAX);
+      s.eventStreamBatch = number("EVENT_STREAM_BATCH", s.eventStreamBatch, 1, 10000);
+      s.eventStreamReclaimIdleMs = number("EVENT_STREAM_RECLAIM_IDLE_MS", s.eventStreamReclaimIdleMs, 1000, MAX);
+      s.jwtSecret = text("JWT_SECRET");
+      s.jwtKeysDir = text("JWT_KEYS_DIR");
+      s.jwtSigningKid = text("JWT_SIGNING_KID");
+      s.accessTokenTTLSeconds = number("ACCESS_TOKEN_TTL_SECONDS", s.accessTokenTTLSeconds, 30, 86400);
+      s.refreshTokenTTLSeconds = number("REFRESH_TOKEN_TTL_SECONDS", s.refreshTokenTTLSeconds, 60, MAX);
+      s.jwtCacheMaxBytes = number("JWT_CACHE_MAX_BYTES", s.jwtCacheMaxBytes, 0, MAX);
+      s.jwtCacheMaxTTLSeconds = number("JWT_CACHE_MAX_TTL_SECONDS", s.jwtCacheMaxTTLSeconds, 0, MAX);
+      s.jwtRevocationCapacity = number("JWT_REVOCATION_CAPACITY", s.jwtRevocationCapacity, 1000, 100000000);
+      s.passwordHashThreads = number("PASSWORD_HASH_THREADS", s.passwordHashThreads, 1, 256);
+      s.passwordHashQueueSize = number("PASSWORD_HASH_QUEUE", s.passwordHashQueueSize, 1, MAX);
+      s.scryptLogN = number("SCRYPT_LOG_N", s.scryptLogN, 10, 22);
+      s.scryptR = number("SCRYPT_R", s.scryptR, 1, 32);
+      s.scryptP = number("SCRYPT_P", s.scryptP, 1, 16);
+      s.loginIpPerMinute = number("LOGIN_IP_PER_MINUTE", s.loginIpPerMinute, 0, MAX);
+      s.loginIpBurst = number("LOGIN_IP_BURST", s.loginIpBurst, 1, MAX);
+      s.loginEmailPerMinute = number("LOGIN_EMAIL_PER_MINUTE", s.loginEmailPerMinute, 0, MAX);
+      s.loginEmailBurst = number("LOGIN_EMAIL_BURST", s.loginEmailBurst, 1, MAX);
+      s.loginLimitLease = number("LOGIN_LIMIT_LEASE", s.loginLimitLease, 1, 64);
+
+      if (s.dbPoolMinSize > s.dbPoolMaxSize)
+      {
+        throw std::invalid_argument("DB_POOL_MIN must not exceed DB_POOL_MAX");
+      }
+      if (s.usersPageSize > s.usersMaxPageSize)
+      {
+        throw std::invalid_argument("USERS_PAGE_SIZE must not exceed USERS_MAX_PAGE_SIZE");
+      }
+      return s;
+    }
+
+  private:
+    static std::map<std::string, std::string> readConfigFile()
+    {
+      std::map<std::string, std::string> values;
+      const char *path = std::getenv("CONFIG_FILE");
+      if (!path || !*path)
+      {
+        return values;
+      }
+
+      std::ifstream file(path);
+      if (!file)
+      {
+        throw std::invalid_argument(std::string("CONFIG_FILE cannot be read: ") + path);
+      }
+
+      std::string line;
+      while (std::getline(file, line))
+      {
+        auto eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos)
+        {
+          continue;
+        }
+        values[line.substr(0, eq)] = line.substr(eq + 1);
+      }
+      return values;
+    }
+  };
+
   struct AppConfig
   {
     static constexpr const char *VERSION = "1.0.0";
 
-    static const char *getEnvVar(const std::string &key)
+    using ReloadListener = std::function<void(const Settings &previous, const Settings &current)>;
+
+    // The current snapshot: one atomic load, no lock. Loads lazily for code
+    // that runs before main() calls load().
+    static const Settings &current()
+    {
+      auto *settings = state().current.load(std::memory_order_acquire);
+      return settings ? *settings : load();
+    }
+
+    // Parse and publish the first snapshot; throws std::invalid_argument on bad values
+    static const Settings &load()
+    {
+      auto &config = state();
+      std::lock_guard<std::mutex> lock(config.mtx);
+      if (auto *settings = config.current.load(std::memory_order_acquire))
+      {
+        return *settings;
+      }
+      return *publish(config, Settings::load());
+    }
+
+    // Re-read the environment and CONFIG_FILE, swap in the new snapshot and
+    // notify listeners. Keeps the current snapshot when the new one is invalid.
+    static bool reload()
+    {
+      const Settings *previous = nullptr;
+      const Settings *next = nullptr;
+      std::vector<ReloadListener> listeners;
+      {
+        auto &config = state();
+        std::lock_guard<std::mutex> lock(config.mtx);
+        try
+        {
+          auto settings = Settings::load();
+          previous = config.current.load(std::memory_order_acquire);
+          next = publish(config, std::move(settings));
+          listeners = config.listeners;
+        }
+        catch (const std::exception &e)
+        {
+          std::cerr << "[Config] Reload rejected: " << e.what() << std::endl;
+          return false;
+        }
+      }
+
+      std::cout << "[Config] Reloaded configuration" << std::endl;
+      if (previous)
+      {
+        for (const auto &listener : listeners)
+        {
+          listener(*previous, *next);
+        }
+      }
+      return true;
+    }
+
+    // Called after every successful reload with the old and new snapshots
+    static void onReload(ReloadListener listener)
     {
-      const char *val = std::getenv(key.c_str());
-      val == nullptr ? std::string() : std::string(val);
-      return val;
+      auto &config = state();
+      std::lock_guard<std::mutex> lock(config.mtx);
+      config.listeners.push_back(std::move(listener));
     }
 
     static const char *getMySQLHost()
     {
-      return getEnvVar("MYSQL_HOST");
+      return orNull(current().mysqlHost);
     }
 
     static const char *getMySQLUser()
     {
-      return getEnvVar("MYSQL_USER");
+      return orNull(current().mysqlUser);
     }
 
     static const char *getMySQLPassword()
     {
-      return getEnvVar("MYSQL_PASSWORD");
+      return orNull(current().mysqlPassword);
     }
 
     static const char *getMySQLDatabase()
     {
-      return getEnvVar("MYSQL_DATABASE");
+      return orNull(current().mysqlDatabase);
     }
 
     static int getMySQLPort()
     {
-      return 3306;
+      return current().mysqlPort;
+    }
+
+    // MySQL connection pool
+    static int getDBPoolMinSize()
+    {
+      return current().dbPoolMinSize;
+    }
+
+    static int getDBPoolMaxSize()
+    {
+      return current().dbPoolMaxSize;
+    }
+
+    static int getDBPoolTimeoutMs()
+    {
+      return current().dbPoolTimeoutMs;
+    }
+
+    static int getDBPoolIdleTimeoutMs()
+    {
+      return current().dbPoolIdleTimeoutMs;
+    }
+
+    // Worker threads that run database work off the Crow I/O threads
+    static int getDBExecutorThreads()
+    {
+      return current().dbExecutorThreads;
+    }
+
+    static int getDBExecutorQueueSize()
+    {
+      return current().dbExecutorQueueSize;
+    }
+
+    // GET /api/users pagination
+    static int getUsersPageSize()
+    {
+      return current().usersPageSize;
+    }
+
+    static int getUsersMaxPageSize()
+    {
+      return current().usersMaxPageSize;
+    }
+
+    // Largest array accepted by POST /api/users/bulk
+    static int getUsersBulkMax()
+    {
+      return current().usersBulkMax;
+    }
+
+    static int getUserCacheTTLSeconds()
+    {
+      return current().userCacheTTLSeconds;
+    }
+
+    // In-process user cache in front of Redis
+    static int getUserL1TTLSeconds()
+    {
+      return current().userL1TTLSeconds;
+    }
+
+    static int getUserL1MaxBytes()
+    {
+      return current().userL1MaxBytes;
     }
 
     static int getPort()
     {
-      return getEnvVar("PORT") ? std::stoi(getEnvVar("PORT")) : 3000;
+      return current().port;
     }
 
     static const char *getRedisHost()
     {
-      return getEnvVar("REDIS_HOST");
+      return orNull(current().redisHost);
     }
 
     static int getRedisPort()
     {
-      return getEnvVar("REDIS_PORT") ? std::stoi(getEnvVar("REDIS_PORT")) : 6379;
+      return current().redisPort;
+    }
+
+    static int getRedisPoolSize()
+    {
+      return current().redisPoolSize;
+    }
+
+    static int getRedisPoolWaitMs()
+    {
+      return current().redisPoolWaitMs;
+    }
+
+    static int getRedisPoolIdleMs()
+    {
+      return current().redisPoolIdleMs;
+    }
+
+    static int getRedisTimeoutMs()
+    {
+      return current().redisTimeoutMs;
+    }
+
+    static int getRedisGetBatchWindowUs()
+    {
+      return current().redisGetBatchWindowUs;
+    }
+
+    static int getRedisGetBatchMax()
+    {
+      return current().redisGetBatchMax;
+    }
+
+    static const char *getLogFile()
+    {
+      return orNull(current().logFile);
+    }
+
+    static int getLogQueueSize()
+    {
+      return current().logQueueSize;
+    }
+
+    static int getLogMaxBytes()
+    {
+      return current().logMaxBytes;
+    }
+
+    static int getLogMaxFiles()
+    {
+      return current().logMaxFiles;
+    }
+
+    static int getLogCompressLevel()
+    {
+      return current().logCompressLevel;
+    }
+
+    static int getEventThreads()
+    {
+      return current().eventThreads;
+    }
+
+    static int getEventQueueSize()
+    {
+      return current().eventQueueSize;
+    }
+
+    static int getEventChannelPending()
+    {
+      return current().eventChannelPending;
+    }
+
+    static int getEventStreamMaxLen()
+    {
+      return current().eventStreamMaxLen;
+    }
+
+    static int getEventStreamBatch()
+    {
+      return current().eventStreamBatch;
+    }
+
+    static int getEventStreamReclaimIdleMs()
+    {
+      return current().eventStreamReclaimIdleMs;
     }
 
     static const char *getJWTSecret()
     {
-      return getEnvVar("JWT_SECRET");
+      return orNull(current().jwtSecret);
+    }
+
+    // Directory of <kid>.pem keys for RS256/ES256/EdDSA, and the kid that signs
+    static const char *getJWTKeysDir()
+    {
+      return orNull(current().jwtKeysDir);
+    }
+
+    static const char *getJWTSigningKid()
+    {
+      return orNull(current().jwtSigningKid);
+    }
+
+    // Access tokens are short-lived; refresh tokens renew them via /api/auth/refresh
+    static int getAccessTokenTTLSeconds()
+    {
+      return current().accessTokenTTLSeconds;
+    }
+
+    static int getRefreshTokenTTLSeconds()
+    {
+      return current().refreshTokenTTLSeconds;
+    }
+
+    static int getJWTCacheMaxBytes()
+    {
+      return current().jwtCacheMaxBytes;
+    }
+
+    // Upper bound on how long a verified token is trusted without a recheck
+    static int getJWTCacheMaxTTLSeconds()
+    {
+      return current().jwtCacheMaxTTLSeconds;
+    }
+
+    // Live revocations the local Bloom filter is sized for
+    static int getJWTRevocationCapacity()
+    {
+      return current().jwtRevocationCapacity;
+    }
+
+    // Password hashing pool and scrypt cost (N = 2^logN)
+    static int getPasswordHashThreads()
+    {
+      return current().passwordHashThreads;
+    }
+
+    static int getPasswordHashQueueSize()
+    {
+      return current().passwordHashQueueSize;
+    }
+
+    static int getScryptLogN()
+    {
+      return current().scryptLogN;
+    }
+
+    static int getScryptR()
+    {
+      return current().scryptR;
+    }
+
+    static int getScryptP()
+    {
+      return current().scryptP;
+    }
+
+    // Login token buckets per client IP and per email; a rate of 0 disables one
+    static int getLoginIpPerMinute()
+    {
+      return current().loginIpPerMinute;
+    }
+
+    static int getLoginIpBurst()
+    {
+      return current().loginIpBurst;
+    }
+
+    static int getLoginEmailPerMinute()
+    {
+      return current().loginEmailPerMinute;
+    }
+
+    static int getLoginEmailBurst()
+    {
+      return current().loginEmailBurst;
+    }
+
+    static int getLoginLimitLease()
+    {
+      return current().loginLimitLease;
+    }
+
+  private:
+    struct State
+    {
+      std::atomic<const Settings *> current{nullptr};
+      // Every snapshot ever published. Superseded ones are kept, not freed,
+      // so references and c_str() pointers handed out earlier stay valid.
+      std::vector<std::unique_ptr<Settings>> snapshots;
+      std::vector<ReloadListener> listeners;
+      std::mutex mtx;
+    };
+
+    static State &state()
+    {
+      static State state;
+      return state;
+    }
+
+    static const Settings *publish(State &config, Settings settings)
+    {
+      config.snapshots.push_back(std::make_unique<Settings>(std::move(settings)));
+      const Settings *published = config.snapshots.back().get();
+      config.current.store(published, std::memory_order_release);
+      return published;
+    }
+
+    // Unset and empty values both read as nullptr, as getenv callers expect
+    static const char *orNull(const std::string &value)
+    {
+      return value.empty() ? nullptr : value.c_str();
     }
   };
-}
\ No newline at end of file
+}
@@ -1,9 +1,20 @@
 #pragma once
 #include "crow.h"
 #include <nlohmann/json.hpp>
-#include "../database/DatabaseManager.hpp"
+#include <iostream>
+#include <optional>
+#include "../database/ConnectionPool.hpp"
+#include "../database/DatabaseExecutor.hpp"
+#include "../database/UserRepository.hpp"
+#include "../auth/KeyStore.hpp"
+#include "../auth/LoginRateLimiter.hpp"
+#include "../auth/RevocationList.hpp"
+#include "../auth/SessionStore.hpp"
+#include "../cache/TokenCache.hpp"
+#include "../cache/UserCache.hpp"
+#include "../models/Identity.hpp"
 #include "../models/User.hpp"
-#include "../utils/HashUtils.hpp"
+#include "../utils/PasswordHasher.hpp"
 #include "BaseController.hpp"
 #include "jwt-cpp/jwt.h"
 #include "../config/config.hpp"
@@ -13,63 +24,177 @@ namespace Controllers
   class AuthController : public BaseController
   {
   public:
-    static crow::response login(const crow::request &req)
+    // Runs on the Crow thread before login is queued, so throttled attempts
+    // never take a database worker or wait behind the logins that are allowed
+    static std::optional<crow::response> throttleLogin(const crow::request &req)
+    {
+      auto body = json::parse(req.body, nullptr, false);
+      std::string email;
+      if (body.is_object() && body.contains("email") && body["email"].is_string())
+      {
+        email = body["email"].get<std::string>();
+      }
+
+      auto limit = Auth::LoginRateLimiter::acquire(req.remote_ip_address, email);
+      if (!limit.allowed)
+      {
+        return too_many_requests("Too many login attempts, try again later", limit.retryAfterSeconds);
+      }
+      return std::nullopt;
+    }
+
+    // Expects throttleLogin to have let the request through. The user lookup
+    // runs on the database executor, then verification, the session and the
+    // tokens on the hasher pool, which ends res; neither waits on the other.
+    static void login(const crow::request &req, crow::response &res)
+    {
+      DatabaseExecutor::respond(res, [&req, &res]() -> std::optional<crow::response>
+                                {
+        try
+        {
+          auto jsonData = parse_body(req);
+
+          std::string email = jsonData["email"].get<std::string>();
+          std::string password = jsonData["password"].get<std::string>();
+
+          // Query user by email
+          auto result = Cache::UserCache::getByEmail(email, [&email]
+                                                     {
+            auto conn = ConnectionPool::acquire();
+            return UserRepository::findByEmail(conn.getDatabase(), email); });
+
+          PasswordHasher::respond(res, [user = std::move(result), password = std::move(password)]
+                                  { return authenticate(user, password); });
+          return std::nullopt;
+        }
+        catch (const std::runtime_error &e)
+        {
+          return bad_request(e.what());
+        }
+        catch (const std::exception &e)
+        {
+          return server_error(e.what());
+        } });
+    }
+
+    // Swap a refresh token for a new access token and refresh token. Claims
+    // come from the session, so this never queries MySQL.
+    static crow::response refresh(const crow::request &req)
     {
       try
       {
         auto jsonData = parse_body(req);
+        std::string refreshToken = jsonData["refresh_token"].get<std::string>();
+
+        const auto &keys = Auth::KeyStore::current();
+        if (!keys.canSign())
+        {
+          return server_error("JWT signing key not configured");
+        }
+
+        auto rotation = Auth::SessionStore::rotate(refreshToken);
+        if (rotation.status != Auth::SessionStore::RotateStatus::Rotated)
+        {
+          return unauthorized("Invalid refresh token");
+        }
+
+        const auto &session = rotation.session;
+        return ok(tokens(session.userId, session.email, session.id, rotation.refreshToken, keys));
+      }
+      catch (const sw::redis::Error &e)
+      {
+        return service_unavailable("Sessions are unavailable, try again later");
+      }
+      catch (const std::runtime_error &e)
+      {
+        return bad_request(e.what());
+      }
+      catch (const std::exception &e)
+      {
+        return server_error(e.what());
+      }
+    }
 
-        std::string email = jsonData["email"].get<std::string>();
-        std::string password = jsonData["password"].get<std::string>();
+    // Revoke the token the request was authenticated with, on every node,
+    // and end its refresh session
+    static crow::response logout(const std::string &tokenKey, const Identity &caller)
+    {
+      try
+      {
+        Auth::RevocationList::revoke(tokenKey, caller.expiresAt);
+        if (!caller.sessionId.empty())
+        {
+          Auth::SessionStore::end(caller.sessionId);
+        }
+        return ok({{"message", "Logged out"}});
+      }
+      catch (const sw::redis::Error &e)
+      {
+        return service_unavailable("Token revocation is unavailable, try again later");
+      }
+    }
 
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
+    // Public keys for verifying our tokens, e.g. by other services
+    static crow::response jwks()
+    {
+      crow::response res(200, Auth::KeyStore::current().jwks());
+      res.add_header("Content-Type", "application/json; charset=utf-8");
+      res.add_header("Cache-Control", "public, max-age=300");
+      return res;
+    }
 
-        // Query user by email
-        char buffer[256];
-        sprintf(buffer, "email='%s'", email.c_str());
-        auto result = db.query<User>(buffer);
+    static crow::response stats()
+    {
+      return ok({{"token_cache", Cache::TokenCache::stats()},
+                 {"password_hasher", PasswordHasher::stats()},
+                 {"rate_limiter", Auth::LoginRateLimiter::stats()},
+                 {"revocations", Auth::RevocationList::stats()},
+                 {"sessions", Auth::SessionStore::stats()}});
+    }
 
-        if (result.empty())
+  private:
+    // On a hasher thread: check the password and open a session
+    static crow::response authenticate(const std::optional<User> &user, const std::string &password)
+    {
+      try
+      {
+        if (!user)
         {
+          PasswordHasher::verifyDummy(password);
           return unauthorized("Invalid email or password");
         }
 
-        // Verify password
-        if (!verifyPassword(email, password))
+        // Verify password against the row we already have
+        auto check = PasswordHasher::verify(password, user->password);
+        if (!check.valid)
         {
           return unauthorized("Invalid email or password");
         }
+        if (check.needsRehash)
+        {
+          upgradeHash(*user, password);
+        }
 
         // Generate JWT token
-        const char *jwt_secret = Config::AppConfig::getJWTSecret();
-
-        printf("JWT secret: %s\n", jwt_secret);
+        const auto &keys = Auth::KeyStore::current();
 
-        if (!jwt_secret)
+        if (!keys.canSign())
         {
-          return server_error("JWT secret not configured");
+          return server_error("JWT signing key not configured");
         }
 
-        auto token = jwt::create()
-                         .set_issuer("auth")
-                         .set_type("JWS")
-                         .set_issued_at(std::chrono::system_clock::now())
-                         .set_expires_at(std::chrono::system_clock::now() + std::chrono::hours{24})
-                         .set_payload_claim("user_id", jwt::claim(std::to_string(result[0].id)))
-                         .set_payload_claim("email", jwt::claim(result[0].email))
-                         .sign(jwt::algorithm::hs256{jwt_secret});
+        auto refreshToken = Auth::SessionStore::create(user->id, user->email);
+        auto sessionId = refreshToken.substr(0, refreshToken.find('.'));
 
-        json response = {
-            {"message", "Login successful"},
-            {"token", token},
-            {"user", {{"id", result[0].id}, {"name", result[0].name}, {"email", result[0].email}}}};
+        json response = tokens(user->id, user->email, sessionId, refreshToken, keys);
+        response["message"] = "Login successful";
+        response["user"] = {{"id", user->id}, {"name", user->name}, {"email", user->email}};
 
         return ok(response);
       }
-      catch (const std::runtime_error &e)
+      catch (const sw::redis::Error &e)
       {
-        return bad_request(e.what());
+        return service_unavailable("Sessions are unavailable, try again later");
       }
       catch (const std::exception &e)
       {
@@ -77,29 +202,55 @@ namespace Controllers
       }
     }
 
-  private:
-    static bool verifyPassword(const std::string &email, const std::string &password)
+    static json tokens(int64_t userId, const std::string &email, const std::string &sessionId,
+                       const std::string &refreshToken, const Auth::KeySet &keys)
     {
-      try
+      auto ttl = Config::AppConfig::getAccessTokenTTLSeconds();
+      auto now = std::chrono::system_clock::now();
+      auto builder = jwt::create();
+      builder.set_issuer("auth")
+          .set_type("JWS")
+          .set_issued_at(now)
+          .set_expires_at(now + std::chrono::seconds{ttl})
+          .set_payload_claim("user_id", jwt::claim(std::to_string(userId)))
+          .set_payload_claim("email", jwt::claim(email))
+          .set_payload_claim("sid", jwt::claim(sessionId));
+      if (!keys.signingKid().empty())
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
-
-        char buffer[256];
-        sprintf(buffer, "email='%s'", email.c_str());
-        auto result = db.query<User>(buffer);
+        builder.set_key_id(keys.signingKid());
+      }
+      auto token = builder.sign(keys.signer());
 
-        if (result.empty())
-        {
-          return false;
-        }
+      return {{"token", token},
+              {"expires_in", ttl},
+              {"refresh_token", refreshToken}};
+    }
 
-        // Compare hashed passwords
-        return result[0].password == HashUtils::sha256(password);
+    // Rehash-on-login: the plaintext is only available now, so legacy SHA-256
+    // rows and hashes with outdated KDF parameters are upgraded here. The hash
+    // is made on this hasher thread and stored from the database executor
+    // without waiting. A failure only delays the upgrade to the next login.
+    static void upgradeHash(const User &user, const std::string &password)
+    {
+      try
+      {
+        auto upgraded = PasswordHasher::hash(password);
+        DatabaseExecutor::submit([id = user.id, email = user.email, upgraded]
+                                 {
+          try
+          {
+            auto conn = ConnectionPool::acquire();
+            UserRepository::updatePassword(conn.getDatabase(), id, upgraded);
+            Cache::UserCache::invalidate(id, email);
+          }
+          catch (const std::exception &e)
+          {
+            std::cerr << "[Auth] Password rehash for user " << id << " failed: " << e.what() << std::endl;
+          } });
       }
       catch (const std::exception &e)
       {
-        return false;
+        std::cerr << "[Auth] Password rehash for user " << user.id << " failed: " << e.what() << std::endl;
       }
     }
   };
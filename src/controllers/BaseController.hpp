@@ -1,6 +1,7 @@
 #pragma once
 #include "crow.h"
 #include <nlohmann/json.hpp>
+#include <optional>
 
 namespace Controllers
 {
@@ -40,6 +41,44 @@ namespace Controllers
       return error_response(401, message);
     }
 
+    static crow::response forbidden(const std::string &message)
+    {
+      return error_response(403, message);
+    }
+
+    static crow::response conflict(const std::string &message)
+    {
+      return error_response(409, message);
+    }
+
+    static crow::response too_many_requests(const std::string &message, int retryAfterSeconds)
+    {
+      auto res = error_response(429, message);
+      res.add_header("Retry-After", std::to_string(retryAfterSeconds));
+      return res;
+    }
+
+    static crow::response service_unavailable(const std::string &message)
+    {
+      return error_response(503, message);
+    }
+
+    // End an asynchronous response with a step's result. A step that passed
+    // res on to another pool returns std::nullopt, and that pool ends it.
+    static void complete(crow::response &res, crow::response result)
+    {
+      res = std::move(result);
+      res.end();
+    }
+
+    static void complete(crow::response &res, std::optional<crow::response> result)
+    {
+      if (result)
+      {
+        complete(res, std::move(*result));
+      }
+    }
+
     // Request helpers
     static json parse_body(const crow::request &req)
     {
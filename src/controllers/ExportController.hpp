@@ -2,7 +2,8 @@
 #include "crow.h"
 #include "BaseController.hpp"
 #include "../export/DataExporter.hpp"
-#include "../database/DatabaseManager.hpp"
+#include "../database/ConnectionPool.hpp"
+#include "../database/UserRepository.hpp"
 #include "../models/User.hpp"
 
 namespace Controllers
@@ -15,9 +16,9 @@ namespace Controllers
     {
       try
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
-        auto users = db.query<User>();
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        auto users = UserRepository::all(db);
 
         json data = json::array();
         for (const auto &user : users)
@@ -40,9 +41,9 @@ namespace Controllers
     {
       try
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
-        auto users = db.query<User>();
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        auto users = UserRepository::all(db);
 
         json data = json::array();
         for (const auto &user : users)
@@ -3,6 +3,8 @@
 #include <nlohmann/json.hpp>
 #include "BaseController.hpp"
 #include "../redis/RedisManager.hpp"
+#include "../events/EventStream.hpp"
+#include "../events/logEvent.hpp"
 
 using json = nlohmann::json;
 
@@ -46,16 +48,11 @@ namespace Controllers
       return ok(response);
     }
 
-    // example of send message to event
+    // example of send message to event; the stream keeps it until a node
+    // handles it, where a pub/sub publish would be lost if no one listens
     static crow::response sendMessage()
     {
-      RedisManager redis_manager;
-
-      // Use the Redis connection
-      auto redis = redis_manager.getRedis();
-
-      // create a publisher
-      redis->publish("log", "Hello, world!");
+      Events::EventStream::publish(LogEventHandler::STREAM, "Hello, world!");
 
       json response = {
           {"message", "Message sent to event"},
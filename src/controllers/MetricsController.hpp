@@ -0,0 +1,19 @@
+#pragma once
+#include "crow.h"
+#include "BaseController.hpp"
+#include "../metrics/RequestMetrics.hpp"
+
+namespace Controllers
+{
+  class MetricsController : public BaseController
+  {
+  public:
+    // Prometheus scrape endpoint
+    static crow::response metrics()
+    {
+      crow::response res(200, Metrics::RequestMetrics::prometheus());
+      res.add_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+      return res;
+    }
+  };
+}
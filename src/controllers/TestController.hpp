@@ -5,6 +5,13 @@
 #include "../utils/StringUtils.hpp"
 #include "../utils/DateUtils.hpp"
 #include "../validation/Validator.hpp"
+#include "../cache/LruCache.hpp"
+#include "../cache/TokenCache.hpp"
+#include "../utils/BloomFilter.hpp"
+#include "../metrics/RequestMetrics.hpp"
+#include "../middlewares/MetricsMiddleware.hpp"
+#include "../utils/PasswordHasher.hpp"
+#include "../utils/HashUtils.hpp"
 
 namespace Controllers
 {
@@ -136,6 +143,30 @@ namespace Controllers
 
         runner.addSuite(&validationTests);
 
+        // Cache Tests
+        Testing::TestSuite cacheTests("Cache Tests");
+        addCacheTests(cacheTests);
+
+        runner.addSuite(&cacheTests);
+
+        // Metrics Tests
+        Testing::TestSuite metricsTests("Metrics Tests");
+        addMetricsTests(metricsTests);
+
+        runner.addSuite(&metricsTests);
+
+        // Password Hasher Tests
+        Testing::TestSuite passwordTests("PasswordHasher Tests");
+        addPasswordTests(passwordTests);
+
+        runner.addSuite(&passwordTests);
+
+        // Hash Utils Tests
+        Testing::TestSuite hashTests("HashUtils Tests");
+        addHashTests(hashTests);
+
+        runner.addSuite(&hashTests);
+
         // Get results as JSON
         json response = runner.toJson();
 
@@ -211,12 +242,278 @@ namespace Controllers
           return ok(suite.run().toJson());
         }
 
-        return not_found("Test suite not found. Available: string, date, validation");
+        else if (suiteName == "cache")
+        {
+          Testing::TestSuite suite("Cache Tests");
+          addCacheTests(suite);
+
+          return ok(suite.run().toJson());
+        }
+        else if (suiteName == "metrics")
+        {
+          Testing::TestSuite suite("Metrics Tests");
+          addMetricsTests(suite);
+
+          return ok(suite.run().toJson());
+        }
+        else if (suiteName == "password")
+        {
+          Testing::TestSuite suite("PasswordHasher Tests");
+          addPasswordTests(suite);
+
+          return ok(suite.run().toJson());
+        }
+        else if (suiteName == "hash")
+        {
+          Testing::TestSuite suite("HashUtils Tests");
+          addHashTests(suite);
+
+          return ok(suite.run().toJson());
+        }
+
+        return not_found("Test suite not found. Available: string, date, validation, cache, metrics, password, hash");
       }
       catch (const std::exception &e)
       {
         return server_error(e.what());
       }
     }
+
+  private:
+    using TestLru = Cache::ShardedLruCache<std::string, std::string>;
+
+    static TestLru makeTestLru(size_t maxBytes)
+    {
+      return TestLru(maxBytes, 1, [](const std::string &key, const std::string &value)
+                     { return key.size() + value.size(); });
+    }
+
+    static void addCacheTests(Testing::TestSuite &suite)
+    {
+      suite
+          .test("LRU returns stored value", []()
+                {
+            auto cache = makeTestLru(1024);
+            cache.put("a", "1", std::chrono::seconds(10));
+            Testing::Assertions::assertEqual(std::string("1"), cache.get("a").value_or("")); })
+          .test("LRU evicts least recently used entry over budget", []()
+                {
+            auto cache = makeTestLru(4);
+            cache.put("a", "1", std::chrono::seconds(10));
+            cache.put("b", "2", std::chrono::seconds(10));
+            cache.get("a");
+            cache.put("c", "3", std::chrono::seconds(10));
+            Testing::Assertions::assertTrue(cache.get("a").has_value());
+            Testing::Assertions::assertFalse(cache.get("b").has_value()); })
+          .test("LRU drops expired entries", []()
+                {
+            auto cache = makeTestLru(1024);
+            cache.put("a", "1", std::chrono::milliseconds(0));
+            Testing::Assertions::assertFalse(cache.get("a").has_value()); })
+          .test("LRU erase removes entry", []()
+                {
+            auto cache = makeTestLru(1024);
+            cache.put("a", "1", std::chrono::seconds(10));
+            cache.erase("a");
+            Testing::Assertions::assertFalse(cache.get("a").has_value()); })
+          .test("TokenCache returns claims until exp", []()
+                {
+            Cache::TokenCache cache(64 * 1024);
+            Identity claims;
+            claims.userId = 42;
+            claims.expiresAt = std::chrono::system_clock::now() + std::chrono::minutes(5);
+            cache.store(Cache::TokenCache::key("test.token.live"), "test-secret", claims);
+            claims.expiresAt = std::chrono::system_clock::now() - std::chrono::seconds(1);
+            cache.store(Cache::TokenCache::key("test.token.expired"), "test-secret", claims);
+
+            auto live = cache.lookup(Cache::TokenCache::key("test.token.live"), "test-secret");
+            Testing::Assertions::assertTrue(live.has_value());
+            Testing::Assertions::assertEqual((int64_t)42, live->userId);
+            Testing::Assertions::assertFalse(cache.lookup(Cache::TokenCache::key("test.token.expired"), "test-secret").has_value()); })
+          .test("TokenCache flushes when the secret changes", []()
+                {
+            Cache::TokenCache cache(64 * 1024);
+            Identity claims;
+            claims.expiresAt = std::chrono::system_clock::now() + std::chrono::minutes(5);
+            cache.store(Cache::TokenCache::key("test.token.rotate"), "test-secret", claims);
+            Testing::Assertions::assertFalse(cache.lookup(Cache::TokenCache::key("test.token.rotate"), "rotated-secret").has_value()); })
+          .test("BloomFilter has no false negatives", []()
+                {
+            BloomFilter filter(1000);
+            for (int i = 0; i < 1000; ++i)
+            {
+              filter.add(Cache::TokenCache::key("revoked." + std::to_string(i)));
+            }
+            for (int i = 0; i < 1000; ++i)
+            {
+              Testing::Assertions::assertTrue(filter.mightContain(Cache::TokenCache::key("revoked." + std::to_string(i))));
+            } });
+    }
+
+    // Cheapest params verifyNow accepts, unless those are the configured ones
+    static KdfParams staleParams()
+    {
+      auto params = KdfParams::fromConfig();
+      params.logN = params.logN == 10 ? 11 : 10;
+      params.r = 1;
+      return params;
+    }
+
+    // Replace one '$'-separated field of a stored hash
+    static std::string withField(const std::string &stored, size_t index, const std::string &value)
+    {
+      auto parts = StringUtils::split(stored, '$');
+      parts[index] = value;
+      return StringUtils::join(parts, "$");
+    }
+
+    static void addPasswordTests(Testing::TestSuite &suite)
+    {
+      suite
+          .test("hashNow writes the versioned scrypt format", []()
+                {
+            KdfParams params{10, 2, 1};
+            auto stored = PasswordHasher::hashNow("secret", params);
+            auto parts = StringUtils::split(stored, '$');
+            Testing::Assertions::assertEqual((size_t)6, parts.size());
+            Testing::Assertions::assertEqual(std::string(""), parts[0]);
+            Testing::Assertions::assertEqual(std::string("scrypt"), parts[1]);
+            Testing::Assertions::assertEqual(std::string("v=1"), parts[2]);
+            Testing::Assertions::assertEqual(std::string("ln=10,r=2,p=1"), parts[3]);
+            Testing::Assertions::assertNotEqual(stored, PasswordHasher::hashNow("secret", params), "Salt must differ per hash"); })
+          .test("verifyNow accepts the password under the configured params", []()
+                {
+            auto stored = PasswordHasher::hashNow("secret", KdfParams::fromConfig());
+            auto result = PasswordHasher::verifyNow("secret", stored);
+            Testing::Assertions::assertTrue(result.valid);
+            Testing::Assertions::assertFalse(result.needsRehash);
+            Testing::Assertions::assertFalse(PasswordHasher::verifyNow("Secret", stored).valid); })
+          .test("verifyNow flags stale params for rehash", []()
+                {
+            auto stored = PasswordHasher::hashNow("secret", staleParams());
+            auto result = PasswordHasher::verifyNow("secret", stored);
+            Testing::Assertions::assertTrue(result.valid);
+            Testing::Assertions::assertTrue(result.needsRehash);
+            Testing::Assertions::assertFalse(PasswordHasher::verifyNow("wrong", stored).needsRehash); })
+          .test("verifyNow accepts legacy SHA-256 rows and flags them for rehash", []()
+                {
+            auto legacy = HashUtils::sha256("secret");
+            auto result = PasswordHasher::verifyNow("secret", legacy);
+            Testing::Assertions::assertTrue(result.valid);
+            Testing::Assertions::assertTrue(result.needsRehash);
+            auto wrong = PasswordHasher::verifyNow("wrong", legacy);
+            Testing::Assertions::assertFalse(wrong.valid);
+            Testing::Assertions::assertFalse(wrong.needsRehash); })
+          .test("verifyNow rejects corrupt hashes", []()
+                {
+            auto stored = PasswordHasher::hashNow("secret", staleParams());
+            for (const auto &corrupt : {std::string("$scrypt$v=1$ln=10,r=1,p=1$c2FsdA=="),
+                                        withField(stored, 2, "v=2"),
+                                        withField(stored, 3, "ln=ten,r=1,p=1"),
+                                        withField(stored, 4, ""),
+                                        withField(stored, 5, "c2hvcnQ="),
+                                        stored.substr(0, stored.size() - 4)})
+            {
+              Testing::Assertions::assertFalse(PasswordHasher::verifyNow("secret", corrupt).valid, corrupt);
+            } })
+          .test("verifyNow rejects out-of-range params", []()
+                {
+            auto stored = PasswordHasher::hashNow("secret", staleParams());
+            for (const auto &params : {"ln=9,r=1,p=1", "ln=23,r=1,p=1", "ln=64,r=1,p=1", "ln=10,r=0,p=1",
+                                       "ln=10,r=33,p=1", "ln=10,r=1,p=0", "ln=10,r=1,p=17", "ln=-1,r=1,p=1"})
+            {
+              auto result = PasswordHasher::verifyNow("secret", withField(stored, 3, params));
+              Testing::Assertions::assertFalse(result.valid, params);
+              Testing::Assertions::assertFalse(result.needsRehash, params);
+            } });
+    }
+
+    // Every byte value, so each SSE2 lane and the pair table see all nibbles
+    static std::vector<unsigned char> hexTestBytes(size_t length)
+    {
+      std::vector<unsigned char> bytes(length);
+      for (size_t i = 0; i < length; ++i)
+      {
+        bytes[i] = static_cast<unsigned char>(i * 37 + 11);
+      }
+      return bytes;
+    }
+
+    static std::string scalarHex(const std::vector<unsigned char> &bytes)
+    {
+      std::string hex;
+      char pair[3];
+      for (auto byte : bytes)
+      {
+        std::snprintf(pair, sizeof(pair), "%02x", byte);
+        hex += pair;
+      }
+      return hex;
+    }
+
+    static void addHashTests(Testing::TestSuite &suite)
+    {
+      suite
+          .test("toHex matches a scalar reference around the 16 byte block", []()
+                {
+            for (size_t length : {0, 1, 7, 15, 16, 17, 31, 32, 33, 48, 256, 259})
+            {
+              auto bytes = hexTestBytes(length);
+              std::string hex(2 * length, '\0');
+              HashUtils::toHex(bytes.data(), bytes.size(), hex.data());
+              Testing::Assertions::assertEqual(scalarHex(bytes), hex, "length " + std::to_string(length));
+            } })
+          .test("toHex writes no more than 2 * length chars", []()
+                {
+            auto bytes = hexTestBytes(17);
+            std::string hex(2 * bytes.size() + 1, '#');
+            HashUtils::toHex(bytes.data(), bytes.size(), hex.data());
+            Testing::Assertions::assertEqual('#', hex.back()); })
+          .test("fromHex round-trips toHex", []()
+                {
+            for (size_t length : {1, 15, 16, 17, 32, 256})
+            {
+              auto bytes = hexTestBytes(length);
+              std::string hex(2 * length, '\0');
+              HashUtils::toHex(bytes.data(), bytes.size(), hex.data());
+              std::vector<unsigned char> decoded(length);
+              Testing::Assertions::assertTrue(HashUtils::fromHex(hex, decoded.data(), decoded.size()));
+              Testing::Assertions::assertTrue(bytes == decoded, "length " + std::to_string(length));
+            } })
+          .test("fromHex accepts uppercase digits", []()
+                {
+            unsigned char out[2];
+            Testing::Assertions::assertTrue(HashUtils::fromHex("aBcD", out, sizeof(out)));
+            Testing::Assertions::assertEqual(0xab, static_cast<int>(out[0]));
+            Testing::Assertions::assertEqual(0xcd, static_cast<int>(out[1])); })
+          .test("fromHex rejects bad and odd-length input", []()
+                {
+            unsigned char out[2];
+            for (const char *bad : {"abc", "abcde", "", "abcdef", "abcg", "ab c", "0x12", "-1ab", "ab\xff" "1"})
+            {
+              Testing::Assertions::assertFalse(HashUtils::fromHex(bad, out, sizeof(out)), bad);
+            } });
+    }
+
+    static void addMetricsTests(Testing::TestSuite &suite)
+    {
+      using Metrics::RequestMetrics;
+      suite
+          .test("unlabelled requests share one series", []()
+                {
+            Middlewares::MetricsMiddleware::context ctx;
+            Testing::Assertions::assertEqual(std::string(RequestMetrics::OTHER), std::string(ctx.route)); })
+          .test("bucketFor picks the smallest power of two bound", []()
+                {
+            Testing::Assertions::assertEqual((size_t)0, RequestMetrics::bucketFor(0));
+            Testing::Assertions::assertEqual((size_t)0, RequestMetrics::bucketFor(1));
+            Testing::Assertions::assertEqual((size_t)1, RequestMetrics::bucketFor(2));
+            Testing::Assertions::assertEqual((size_t)2, RequestMetrics::bucketFor(3));
+            Testing::Assertions::assertEqual((size_t)6, RequestMetrics::bucketFor(64));
+            Testing::Assertions::assertEqual((size_t)7, RequestMetrics::bucketFor(65)); })
+          .test("bucketFor caps at the unbounded bucket", []()
+                {
+            Testing::Assertions::assertEqual(RequestMetrics::BUCKETS - 1, RequestMetrics::bucketFor(uint64_t(1) << 40)); });
+    }
   };
 }
@@ -1,37 +1,99 @@
 #pragma once
 #include "crow.h"
 #include <nlohmann/json.hpp>
-#include "../database/DatabaseManager.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include "../auth/SessionStore.hpp"
+#include "../database/ConnectionPool.hpp"
+#include "../database/DatabaseExecutor.hpp"
+#include "../database/RoundTripStats.hpp"
+#include "../database/UserRepository.hpp"
+#include "../export/JsonArraySpool.hpp"
+#include "../cache/UserCache.hpp"
+#include "../models/Identity.hpp"
 #include "../models/User.hpp"
 #include "BaseController.hpp"
-#include "../utils/HashUtils.hpp"
+#include "../utils/PasswordHasher.hpp"
+#include "../config/config.hpp"
+#include "../utils/StringUtils.hpp"
+#include "../validation/Validator.hpp"
 
 namespace Controllers
 {
   class UserController : public BaseController
   {
   public:
-    static crow::response get()
+    // Keyset-paginated listing: ?after=<cursor or id>&limit=<n>, or ?stream=1
+    // for every user, spooled to a file that spool keeps open
+    static crow::response get(const crow::request &req, Export::SpoolFile &spool)
     {
       try
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
-        auto result = db.query<User>();
+        const char *stream = req.url_params.get("stream");
+        if (stream && std::string(stream) == "1")
+        {
+          return streamAll(spool);
+        }
+
+        int64_t afterId = 0;
+        if (const char *after = req.url_params.get("after"))
+        {
+          auto cursor = decodeCursor(after);
+          if (!cursor)
+          {
+            return bad_request("Invalid cursor");
+          }
+          afterId = *cursor;
+        }
 
-        if (result.empty())
+        int64_t limit = Config::AppConfig::getUsersPageSize();
+        if (const char *limitParam = req.url_params.get("limit"))
+        {
+          char *end = nullptr;
+          limit = std::strtoll(limitParam, &end, 10);
+          if (end == limitParam || *end != '\0' || limit <= 0)
+          {
+            return bad_request("limit must be a positive integer");
+          }
+        }
+        limit = std::min<int64_t>(limit, Config::AppConfig::getUsersMaxPageSize());
+
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+
+        // Fetch one extra row to learn whether another page exists
+        auto result = UserRepository::page(db, afterId, limit + 1);
+
+        if (result.empty() && afterId == 0)
         {
           return not_found("No users found in the database");
         }
 
-        json response = json::array();
+        bool hasMore = static_cast<int64_t>(result.size()) > limit;
+        if (hasMore)
+        {
+          result.pop_back();
+        }
+
+        json data = json::array();
         for (auto &user : result)
         {
-          response.push_back({{"id", user.id},
-                              {"name", user.name},
-                              {"email", user.email}});
+          data.push_back({{"id", user.id},
+                          {"name", user.name},
+                          {"email", user.email}});
         }
 
+        json response = {
+            {"data", data},
+            {"limit", limit},
+            {"next_cursor", hasMore ? json(encodeCursor(result.back().id)) : json(nullptr)}};
+
         return ok(response);
       }
       catch (const std::exception &e)
@@ -40,26 +102,52 @@ namespace Controllers
       }
     }
 
-    static crow::response getOne(int id)
+    // Full listing for admin tooling, written row by row instead of as one JSON document
+    static crow::response streamAll(Export::SpoolFile &file)
     {
       try
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+
+        Export::JsonArraySpool spool;
+        UserRepository::forEach(db, [&](const User &user)
+                                { spool.push({{"id", user.id},
+                                              {"name", user.name},
+                                              {"email", user.email}}); });
+
+        return spool.finish(file);
+      }
+      catch (const std::exception &e)
+      {
+        return server_error(e.what());
+      }
+    }
 
-        char buffer[100];
-        sprintf(buffer, "id=%d", id);
-        auto result = db.query<User>(buffer);
+    static crow::response stats()
+    {
+      return ok({{"cache", Cache::UserCache::stats()},
+                 {"round_trips", RoundTripStats::snapshot()}});
+    }
 
-        if (result.empty())
+    static crow::response getOne(int id)
+    {
+      try
+      {
+        auto result = Cache::UserCache::getById(id, [id]
+                                                {
+          auto conn = ConnectionPool::acquire();
+          return UserRepository::findById(conn.getDatabase(), id); });
+
+        if (!result)
         {
           return not_found("User not found");
         }
 
         json response = {
-            {"id", result[0].id},
-            {"name", result[0].name},
-            {"email", result[0].email}};
+            {"id", result->id},
+            {"name", result->name},
+            {"email", result->email}};
 
         return ok(response);
       }
@@ -69,35 +157,153 @@ namespace Controllers
       }
     }
 
-    static crow::response create(const crow::request &req)
+    // One round trip: the response is built from the request and the insert id.
+    // The password is hashed on the hasher pool, then the row is inserted on
+    // the database executor, so neither pool waits on the other.
+    static void create(const crow::request &req, crow::response &res)
+    {
+      PasswordHasher::respond(res, [&req, &res]() -> std::optional<crow::response>
+                              {
+        try
+        {
+          auto jsonData = parse_body(req);
+
+          auto user = User();
+          user.name = jsonData["name"].get<std::string>();
+          user.email = jsonData["email"].get<std::string>();
+          // Hash the password before storing, and before holding a connection
+          user.password = PasswordHasher::hash(jsonData["password"].get<std::string>());
+
+          DatabaseExecutor::respond(res, [user = std::move(user)]() mutable
+                                    { return insert(user); });
+          return std::nullopt;
+        }
+        catch (const std::runtime_error &e)
+        {
+          return bad_request(e.what());
+        }
+        catch (const std::exception &e)
+        {
+          return server_error(e.what());
+        } });
+    }
+
+    // Body is an array of {name, email, password}. Every row gets a result entry;
+    // the valid, unregistered ones are inserted together in one transaction.
+    // Emails are checked on the database executor, passwords hashed on the
+    // hasher pool, then the rows inserted back on the executor.
+    static void bulkCreate(const crow::request &req, crow::response &res)
+    {
+      DatabaseExecutor::respond(res, [&req, &res]
+                                { return checkBulk(req, res); });
+    }
+
+    // One round trip: a missing row shows up as zero matched rows.
+    // caller is the identity JWTMiddleware decoded; users may only change themselves.
+    // Hashed on the hasher pool, stored on the database executor, like create.
+    static void update(int id, const crow::request &req, const Identity &caller, crow::response &res)
+    {
+      PasswordHasher::respond(res, [id, &req, caller, &res]() -> std::optional<crow::response>
+                              {
+        try
+        {
+          if (caller.userId != id)
+          {
+            return forbidden("Cannot modify another user");
+          }
+
+          auto jsonData = parse_body(req);
+
+          User user;
+          user.id = id;
+          user.name = jsonData["name"].get<std::string>();
+          user.email = jsonData["email"].get<std::string>();
+          // Hash the password before storing
+          user.password = PasswordHasher::hash(jsonData["password"].get<std::string>());
+
+          DatabaseExecutor::respond(res, [user = std::move(user)]
+                                    { return replace(user); });
+          return std::nullopt;
+        }
+        catch (const std::runtime_error &e)
+        {
+          return bad_request(e.what());
+        }
+        catch (const std::exception &e)
+        {
+          return server_error(e.what());
+        } });
+    }
+
+    // One round trip: a missing row shows up as zero deleted rows
+    static crow::response deleteOne(int id, const Identity &caller)
     {
       try
       {
-        auto jsonData = parse_body(req);
+        if (caller.userId != id)
+        {
+          return forbidden("Cannot delete another user");
+        }
 
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
+        auto previousEmail = Cache::UserCache::cachedEmail(id);
 
-        auto user = User();
-        user.name = jsonData["name"].get<std::string>();
-        user.email = jsonData["email"].get<std::string>();
-        // Hash the password before storing
-        user.password = HashUtils::sha256(jsonData["password"].get<std::string>());
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        RoundTripStats::Scope trips(db, "delete");
 
-        db.insert(user);
+        if (UserRepository::remove(db, id) == 0)
+        {
+          return withRoundTrips(not_found("User not found"), trips);
+        }
 
-        // Get the last inserted user
-        auto result = db.query<User>("id = LAST_INSERT_ID()");
+        Cache::UserCache::invalidate(id, previousEmail.value_or(""));
+        endSessions(id);
+
+        return withRoundTrips(ok({"message", "User deleted successfully"}), trips);
+      }
+      catch (const std::exception &e)
+      {
+        return server_error(e.what());
+      }
+    }
+
+  private:
+    // MySQL ER_DUP_ENTRY, raised by the unique index on users.email
+    static constexpr unsigned int ER_DUP_ENTRY_CODE = 1062;
+    // A deleted or re-credentialed user's refresh tokens must stop minting access tokens
+    static void endSessions(int64_t id)
+    {
+      try
+      {
+        Auth::SessionStore::endAll(id);
+      }
+      catch (const sw::redis::Error &e)
+      {
+        std::cerr << "[Users] Ending sessions of user " << id << " failed: " << e.what() << std::endl;
+      }
+    }
+
+    // create's database step; user.password is already hashed
+    static crow::response insert(User &user)
+    {
+      try
+      {
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        RoundTripStats::Scope trips(db, "create");
+
+        user.id = UserRepository::insert(db, user);
+        Cache::UserCache::invalidate(user.id, user.email);
 
         json response = {
             {"message", "User created successfully"},
-            {"user", {{"id", result[0].id}, {"name", result[0].name}, {"email", result[0].email}}}};
+            {"user", {{"id", user.id}, {"name", user.name}, {"email", user.email}}}};
 
-        return created(response);
+        return withRoundTrips(created(response), trips);
       }
-      catch (const std::runtime_error &e)
+      catch (const DatabaseError &e)
       {
-        return bad_request(e.what());
+        return e.code() == ER_DUP_ENTRY_CODE ? conflict("Email is already registered") : server_error(e.what());
       }
       catch (const std::exception &e)
       {
@@ -105,36 +311,179 @@ namespace Controllers
       }
     }
 
-    static crow::response update(int id, const crow::request &req)
+    // update's database step; user.password is already hashed
+    static crow::response replace(const User &user)
     {
       try
       {
-        auto jsonData = parse_body(req);
+        // Read before the write so a concurrent refill cannot hide the old email
+        auto previousEmail = Cache::UserCache::cachedEmail(user.id);
 
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        RoundTripStats::Scope trips(db, "update");
 
-        char buffer[100];
-        sprintf(buffer, "id=%d", id);
-        auto result = db.query<User>(buffer);
-
-        if (result.empty())
+        if (UserRepository::update(db, user) == 0)
         {
-          return not_found("User not found");
+          return withRoundTrips(not_found("User not found"), trips);
         }
 
-        result[0].name = jsonData["name"].get<std::string>();
-        result[0].email = jsonData["email"].get<std::string>();
-        // Hash the password before storing
-        result[0].password = HashUtils::sha256(jsonData["password"].get<std::string>());
-
-        db.update(result[0]);
+        Cache::UserCache::invalidate(user.id, user.email);
+        if (previousEmail && *previousEmail != user.email)
+        {
+          Cache::UserCache::invalidate(user.id, *previousEmail);
+        }
+        // The password is replaced on every update, so tokens issued against
+        // the old credentials must not outlive it
+        endSessions(user.id);
 
         json response = {
             {"message", "User updated successfully"},
-            {"user", {{"id", result[0].id}, {"name", result[0].name}, {"email", result[0].email}}}};
+            {"user", {{"id", user.id}, {"name", user.name}, {"email", user.email}}}};
 
-        return ok(response);
+        return withRoundTrips(ok(response), trips);
+      }
+      catch (const DatabaseError &e)
+      {
+        return e.code() == ER_DUP_ENTRY_CODE ? conflict("Email is already registered") : server_error(e.what());
+      }
+      catch (const std::exception &e)
+      {
+        return server_error(e.what());
+      }
+    }
+
+    // What bulkCreate carries from the email check to the insert
+    struct BulkCreate
+    {
+      size_t total = 0;
+      json results;
+      std::vector<User> users;
+      std::vector<User *> pending;
+      std::vector<size_t> pendingIndex;
+      uint64_t lookupTrips = 0;
+    };
+
+    static std::optional<crow::response> checkBulk(const crow::request &req, crow::response &res)
+    {
+      try
+      {
+        auto rows = parse_body(req);
+        if (!rows.is_array() || rows.empty())
+        {
+          return bad_request("Expected a non-empty array of users");
+        }
+        if (rows.size() > static_cast<size_t>(Config::AppConfig::getUsersBulkMax()))
+        {
+          return bad_request("At most " + std::to_string(Config::AppConfig::getUsersBulkMax()) + " users per request");
+        }
+
+        json results = json::array();
+        std::vector<User> users;
+        std::vector<size_t> resultIndex;
+        std::unordered_set<std::string> seen;
+        users.reserve(rows.size());
+        resultIndex.reserve(rows.size());
+
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+          const auto &row = rows[i];
+          if (!row.is_object())
+          {
+            results.push_back({{"index", i}, {"status", "invalid"}, {"errors", json::array({"Expected an object"})}});
+            continue;
+          }
+
+          auto validator = Validation::make(row)
+                               .required("name")
+                               .string("name")
+                               .required("email")
+                               .email("email")
+                               .required("password")
+                               .string("password");
+          if (validator.fails())
+          {
+            results.push_back({{"index", i}, {"status", "invalid"}, {"errors", validator.getErrors()["errors"]}});
+            continue;
+          }
+
+          User user;
+          user.name = row["name"].get<std::string>();
+          user.email = row["email"].get<std::string>();
+          user.password = row["password"].get<std::string>();
+
+          // users.email compares case-insensitively, so must the payload check
+          if (!seen.insert(StringUtils::toLower(user.email)).second)
+          {
+            results.push_back({{"index", i}, {"status", "duplicate"}, {"email", user.email}});
+            continue;
+          }
+
+          resultIndex.push_back(results.size());
+          results.push_back({{"index", i}, {"status", "pending"}, {"email", user.email}});
+          users.push_back(std::move(user));
+        }
+
+        std::vector<std::string_view> emails;
+        emails.reserve(users.size());
+        for (const auto &user : users)
+        {
+          emails.push_back(user.email);
+        }
+
+        // Connections are not held while the passwords hash
+        std::unordered_set<std::string> registered;
+        uint64_t lookupTrips = 0;
+        {
+          auto conn = ConnectionPool::acquire();
+          auto &db = conn.getDatabase();
+          auto before = db.roundTrips();
+          for (const auto &email : UserRepository::existingEmails(db, emails))
+          {
+            registered.insert(StringUtils::toLower(email));
+          }
+          lookupTrips = db.roundTrips() - before;
+        }
+
+        std::vector<User *> pending;
+        std::vector<size_t> pendingIndex;
+        for (size_t i = 0; i < users.size(); ++i)
+        {
+          auto &result = results[resultIndex[i]];
+          if (registered.count(StringUtils::toLower(users[i].email)))
+          {
+            result["status"] = "duplicate";
+            continue;
+          }
+          pending.push_back(&users[i]);
+          pendingIndex.push_back(resultIndex[i]);
+        }
+
+        auto state = std::make_shared<BulkCreate>();
+        state->total = rows.size();
+        state->results = std::move(results);
+        // Moving the vector keeps the addresses pending holds
+        state->users = std::move(users);
+        state->pending = std::move(pending);
+        state->pendingIndex = std::move(pendingIndex);
+        state->lookupTrips = lookupTrips;
+
+        std::vector<std::string *> passwords;
+        passwords.reserve(state->pending.size());
+        for (auto *user : state->pending)
+        {
+          passwords.push_back(&user->password);
+        }
+        PasswordHasher::hashAll(std::move(passwords), [state, &res](std::exception_ptr error)
+                                {
+          if (error)
+          {
+            complete(res, hashFailed(error));
+            return;
+          }
+          DatabaseExecutor::respond(res, [state]
+                                    { return insertBulk(*state); }); });
+        return std::nullopt;
       }
       catch (const std::runtime_error &e)
       {
@@ -146,30 +495,132 @@ namespace Controllers
       }
     }
 
-    static crow::response deleteOne(int id)
+    static crow::response insertBulk(BulkCreate &state)
     {
       try
       {
-        DatabaseManager dbManager;
-        auto &db = dbManager.getDatabase();
+        auto &results = state.results;
+        const auto &pending = state.pending;
+        const auto &pendingIndex = state.pendingIndex;
 
-        char buffer[100];
-        sprintf(buffer, "id=%d", id);
-        auto result = db.query<User>(buffer);
+        auto conn = ConnectionPool::acquire();
+        auto &db = conn.getDatabase();
+        RoundTripStats::Scope trips(db, "bulk_create", state.lookupTrips);
 
-        if (result.empty())
+        size_t createdCount = 0;
+        // Ids of one multi-row INSERT are this far apart, e.g. under Galera or
+        // multi-primary replication
+        int64_t idStep = pending.empty() ? 1 : db.autoIncrementIncrement();
+        db.execute("START TRANSACTION");
+        try
         {
-          return not_found("User not found");
+          // One statement per batch instead of one round trip per user
+          for (size_t offset = 0; offset < pending.size(); offset += UserRepository::BULK_BATCH_SIZE)
+          {
+            size_t count = std::min(UserRepository::BULK_BATCH_SIZE, pending.size() - offset);
+            std::vector<const User *> batch(pending.begin() + offset, pending.begin() + offset + count);
+            int64_t firstId = UserRepository::insertBatch(db, batch);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+              auto &result = results[pendingIndex[offset + i]];
+              result["status"] = "created";
+              result["id"] = firstId + static_cast<int64_t>(i) * idStep;
+            }
+            createdCount += count;
+          }
+          db.execute("COMMIT");
+        }
+        catch (...)
+        {
+          try
+          {
+            db.execute("ROLLBACK");
+          }
+          catch (const DatabaseError &)
+          {
+            // The connection is gone; the server rolls back on its own
+          }
+          throw;
         }
 
-        db.delete_records<User>(buffer);
+        // New rows have nothing cached under their id or email, so there is
+        // nothing to invalidate
 
-        return ok({"message", "User deleted successfully"});
+        json response = {
+            {"created", createdCount},
+            {"failed", state.total - createdCount},
+            {"results", results}};
+
+        return withRoundTrips(createdCount > 0 ? created(response) : ok(response), trips);
+      }
+      catch (const DatabaseError &e)
+      {
+        // Another request registered one of the emails after the duplicate check
+        return e.code() == ER_DUP_ENTRY_CODE ? conflict("An email was registered concurrently; no users were created")
+                                             : server_error(e.what());
       }
       catch (const std::exception &e)
       {
         return server_error(e.what());
       }
     }
+
+    // Response for a failed hashing step handed back as an exception_ptr
+    static crow::response hashFailed(std::exception_ptr error)
+    {
+      try
+      {
+        std::rethrow_exception(error);
+      }
+      catch (const QueueFullError &e)
+      {
+        return service_unavailable("Password hashing is busy, try again later");
+      }
+      catch (const std::exception &e)
+      {
+        return server_error(e.what());
+      }
+    }
+
+    static crow::response withRoundTrips(crow::response res, const RoundTripStats::Scope &trips)
+    {
+      res.set_header("X-DB-Round-Trips", std::to_string(trips.count()));
+      return res;
+    }
+
+    static std::string encodeCursor(int64_t id)
+    {
+      std::string raw = "u:" + std::to_string(id);
+      return crow::utility::base64encode_urlsafe(raw, raw.size());
+    }
+
+    // Non-empty and ASCII digits only; ::isdigit is undefined for negative chars
+    static bool isDigits(std::string_view value)
+    {
+      return !value.empty() && std::all_of(value.begin(), value.end(), [](char c)
+                                           { return c >= '0' && c <= '9'; });
+    }
+
+    // Accepts a cursor from next_cursor or a plain numeric id
+    static std::optional<int64_t> decodeCursor(const std::string &value)
+    {
+      std::string raw = value;
+      if (!isDigits(raw))
+      {
+        raw = crow::utility::base64decode(value, value.size());
+        if (raw.rfind("u:", 0) != 0)
+        {
+          return std::nullopt;
+        }
+        raw = raw.substr(2);
+      }
+
+      if (raw.size() > 18 || !isDigits(raw))
+      {
+        return std::nullopt;
+      }
+      return std::stoll(raw);
+    }
   };
 } // namespace Controllers
\ No newline at end of file
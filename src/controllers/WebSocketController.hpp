@@ -1,6 +1,7 @@
 #pragma once
 #include "crow.h"
 #include "BaseController.hpp"
+#include "../models/Identity.hpp"
 #include "../websocket/WebSocketManager.hpp"
 
 namespace Controllers
@@ -39,7 +40,7 @@ namespace Controllers
     }
 
     // Broadcast message to all WebSocket connections via HTTP
-    static crow::response broadcast(const crow::request &req)
+    static crow::response broadcast(const crow::request &req, const Identity &sender)
     {
       try
       {
@@ -50,7 +51,7 @@ namespace Controllers
           return bad_request("Message is required");
         }
 
-        WebSocket::WebSocketManager::broadcast(body["message"]);
+        WebSocket::WebSocketManager::broadcast(withSender(body["message"], sender));
 
         return ok({{"message", "Broadcast sent successfully"}});
       }
@@ -61,7 +62,7 @@ namespace Controllers
     }
 
     // Send message to a specific room via HTTP
-    static crow::response sendToRoom(const crow::request &req, const std::string &room)
+    static crow::response sendToRoom(const crow::request &req, const std::string &room, const Identity &sender)
     {
       try
       {
@@ -72,7 +73,7 @@ namespace Controllers
           return bad_request("Message is required");
         }
 
-        WebSocket::WebSocketManager::sendToRoom(room, body["message"]);
+        WebSocket::WebSocketManager::sendToRoom(room, withSender(body["message"], sender));
 
         return ok({{"message", "Message sent to room: " + room}});
       }
@@ -81,5 +82,17 @@ namespace Controllers
         return server_error(e.what());
       }
     }
+
+  private:
+    // Object messages are stamped with the authenticated sender, replacing any
+    // sender the client supplied
+    static json withSender(json message, const Identity &sender)
+    {
+      if (message.is_object())
+      {
+        message["sender"] = {{"user_id", sender.userId}, {"email", sender.email}};
+      }
+      return message;
+    }
   };
-}
+}
\ No newline at end of file
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../config/config.hpp"
+#include "DatabaseConnection.hpp"
+
+struct PoolOptions
+{
+  size_t minSize = 2;
+  size_t maxSize = 16;
+  std::chrono::milliseconds checkoutTimeout{2000};
+  std::chrono::milliseconds idleTimeout{60000};
+  // Connections idle for longer than this are pinged before being handed out
+  std::chrono::milliseconds validationInterval{5000};
+
+  static PoolOptions fromConfig()
+  {
+    PoolOptions options;
+    options.minSize = static_cast<size_t>(std::max(0, Config::AppConfig::getDBPoolMinSize()));
+    options.maxSize = static_cast<size_t>(std::max(1, Config::AppConfig::getDBPoolMaxSize()));
+    options.minSize = std::min(options.minSize, options.maxSize);
+    options.checkoutTimeout = std::chrono::milliseconds(Config::AppConfig::getDBPoolTimeoutMs());
+    options.idleTimeout = std::chrono::milliseconds(Config::AppConfig::getDBPoolIdleTimeoutMs());
+    return options;
+  }
+};
+
+// Raised when no connection can be handed out. Deliberately not a
+// std::runtime_error so controllers report it as a server error.
+class PoolError : public std::exception
+{
+public:
+  explicit PoolError(std::string message) : message_(std::move(message)) {}
+  const char *what() const noexcept override { return message_.c_str(); }
+
+private:
+  std::string message_;
+};
+
+class ConnectionPool
+{
+public:
+  using Database = DatabaseConnection;
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats
+  {
+    size_t total;
+    size_t idle;
+    size_t inUse;
+    size_t waiting;
+    uint64_t created;
+    uint64_t destroyed;
+    uint64_t timeouts;
+  };
+
+  // RAII handle for a checked-out connection; returns it to the pool on destruction
+  class Lease
+  {
+  public:
+    Lease(ConnectionPool *pool, std::unique_ptr<Database> db) : pool_(pool), db_(std::move(db)) {}
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    Lease(Lease &&other) noexcept : pool_(other.pool_), db_(std::move(other.db_)), broken_(other.broken_)
+    {
+      other.pool_ = nullptr;
+    }
+
+    Lease &operator=(Lease &&other) noexcept
+    {
+      if (this != &other)
+      {
+        release();
+        pool_ = other.pool_;
+        db_ = std::move(other.db_);
+        broken_ = other.broken_;
+        other.pool_ = nullptr;
+      }
+      return *this;
+    }
+
+    ~Lease()
+    {
+      release();
+    }
+
+    Database &getDatabase()
+    {
+      return *db_;
+    }
+
+    // Drop the connection instead of returning it to the pool
+    void invalidate()
+    {
+      broken_ = true;
+    }
+
+  private:
+    ConnectionPool *pool_;
+    std::unique_ptr<Database> db_;
+    bool broken_ = false;
+
+    void release()
+    {
+      if (pool_ && db_)
+      {
+        pool_->release(std::move(db_), broken_);
+      }
+      pool_ = nullptr;
+    }
+  };
+
+  // Configure the pool and open the minimum number of connections
+  static void init(const PoolOptions &options)
+  {
+    auto &pool = instance();
+    {
+      std::lock_guard<std::mutex> lock(pool.mtx_);
+      pool.options_ = options;
+      pool.initialized_ = true;
+    }
+    pool.warmUp();
+    pool.startReaper();
+  }
+
+  // Apply new sizes and timeouts to a running pool. Growth takes effect at
+  // once; connections above a lowered maximum close as they come back.
+  static void reconfigure(const PoolOptions &options)
+  {
+    auto &pool = instance();
+    std::vector<std::unique_ptr<Database>> surplus;
+    {
+      std::lock_guard<std::mutex> lock(pool.mtx_);
+      pool.options_ = options;
+      while (pool.total_ > options.maxSize && !pool.idle_.empty())
+      {
+        surplus.push_back(std::move(pool.idle_.front().db));
+        pool.idle_.pop_front();
+        --pool.total_;
+        ++pool.destroyed_;
+      }
+    }
+    surplus.clear();
+    pool.available_.notify_all();
+    pool.reaperWake_.notify_all();
+    pool.warmUp();
+  }
+
+  // Check out a connection, waiting up to the configured timeout
+  static Lease acquire()
+  {
+    auto &pool = instance();
+    if (!pool.initialized_.load())
+    {
+      init(PoolOptions::fromConfig());
+    }
+    return pool.checkout();
+  }
+
+  static Stats stats()
+  {
+    auto &pool = instance();
+    std::lock_guard<std::mutex> lock(pool.mtx_);
+    return {pool.total_,
+            pool.idle_.size(),
+            pool.total_ - pool.idle_.size(),
+            pool.waiting_,
+            pool.created_,
+            pool.destroyed_,
+            pool.timeouts_};
+  }
+
+  static void shutdown()
+  {
+    instance().stop();
+  }
+
+  ~ConnectionPool()
+  {
+    stop();
+  }
+
+private:
+  struct Slot
+  {
+    std::unique_ptr<Database> db;
+    Clock::time_point lastUsed;
+  };
+
+  PoolOptions options_;
+  std::deque<Slot> idle_;
+  size_t total_ = 0;
+  size_t waiting_ = 0;
+  uint64_t created_ = 0;
+  uint64_t destroyed_ = 0;
+  uint64_t timeouts_ = 0;
+  std::atomic<bool> initialized_{false};
+  std::atomic<bool> running_{false};
+  std::mutex mtx_;
+  std::condition_variable available_;
+  std::condition_variable reaperWake_;
+  std::thread reaper_;
+
+  ConnectionPool() = default;
+
+  static ConnectionPool &instance()
+  {
+    static ConnectionPool instance;
+    return instance;
+  }
+
+  std::unique_ptr<Database> openConnection()
+  {
+    try
+    {
+      return Database::open();
+    }
+    catch (const DatabaseError &e)
+    {
+      throw PoolError(e.what());
+    }
+  }
+
+  void warmUp()
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (total_ < options_.minSize)
+    {
+      ++total_;
+      lock.unlock();
+      try
+      {
+        auto db = openConnection();
+        lock.lock();
+        ++created_;
+        idle_.push_back({std::move(db), Clock::now()});
+      }
+      catch (const std::exception &e)
+      {
+        lock.lock();
+        --total_;
+        std::cerr << "[ConnectionPool] Warm-up failed: " << e.what() << std::endl;
+        return;
+      }
+    }
+  }
+
+  Lease checkout()
+  {
+    // options_ may be replaced by reconfigure, so only read it under the lock
+    std::unique_lock<std::mutex> lock(mtx_);
+    auto deadline = Clock::now() + options_.checkoutTimeout;
+
+    while (true)
+    {
+      if (!idle_.empty())
+      {
+        // Most recently used first: its socket is the least likely to have gone stale
+        Slot slot = std::move(idle_.back());
+        idle_.pop_back();
+        auto validationInterval = options_.validationInterval;
+        lock.unlock();
+
+        if (Clock::now() - slot.lastUsed < validationInterval || slot.db->ping())
+        {
+          return Lease(this, std::move(slot.db));
+        }
+
+        slot.db.reset();
+        lock.lock();
+        --total_;
+        ++destroyed_;
+        continue;
+      }
+
+      if (total_ < options_.maxSize)
+      {
+        ++total_;
+        lock.unlock();
+        try
+        {
+          auto db = openConnection();
+          lock.lock();
+          ++created_;
+          lock.unlock();
+          return Lease(this, std::move(db));
+        }
+        catch (...)
+        {
+          lock.lock();
+          --total_;
+          available_.notify_one();
+          throw;
+        }
+      }
+
+      ++waiting_;
+      bool signalled = available_.wait_until(lock, deadline, [this]
+                                             { return !idle_.empty() || total_ < options_.maxSize; });
+      --waiting_;
+
+      if (!signalled)
+      {
+        ++timeouts_;
+        throw PoolError("Timed out waiting for a database connection");
+      }
+    }
+  }
+
+  void release(std::unique_ptr<Database> db, bool broken)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (broken || db->broken() || !running_.load() || total_ > options_.maxSize)
+      {
+        --total_;
+        ++destroyed_;
+      }
+      else
+      {
+        idle_.push_back({std::move(db), Clock::now()});
+      }
+    }
+    available_.notify_one();
+  }
+
+  void startReaper()
+  {
+    if (running_.exchange(true))
+    {
+      return;
+    }
+    reaper_ = std::thread(&ConnectionPool::reapLoop, this);
+  }
+
+  // Close connections that sat idle past the idle timeout, keeping minSize open
+  void reapLoop()
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (running_.load())
+    {
+      auto interval = std::min<std::chrono::milliseconds>(options_.idleTimeout / 2, std::chrono::milliseconds(1000));
+      reaperWake_.wait_for(lock, std::max(interval, std::chrono::milliseconds(10)));
+
+      auto cutoff = Clock::now() - options_.idleTimeout;
+      std::vector<std::unique_ptr<Database>> expired;
+
+      // Oldest connections sit at the front of the deque
+      while (!idle_.empty() && total_ > options_.minSize && idle_.front().lastUsed < cutoff)
+      {
+        expired.push_back(std::move(idle_.front().db));
+        idle_.pop_front();
+        --total_;
+        ++destroyed_;
+      }
+
+      if (!expired.empty())
+      {
+        lock.unlock();
+        expired.clear();
+        available_.notify_all();
+        lock.lock();
+      }
+    }
+  }
+
+  void stop()
+  {
+    if (!running_.exchange(false))
+    {
+      return;
+    }
+    reaperWake_.notify_all();
+    if (reaper_.joinable())
+    {
+      reaper_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    destroyed_ += idle_.size();
+    total_ -= idle_.size();
+    idle_.clear();
+  }
+};
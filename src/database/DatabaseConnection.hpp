@@ -0,0 +1,557 @@
+#pragma once
+
+#include <mysql.h>
+#include <array>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "../config/config.hpp"
+
+// Raised for MySQL client and server errors. Not a std::runtime_error so
+// controllers report it as a server error rather than a bad request.
+class DatabaseError : public std::exception
+{
+public:
+  explicit DatabaseError(std::string message, unsigned int code = 0)
+      : message_(std::move(message)), code_(code) {}
+  const char *what() const noexcept override { return message_.c_str(); }
+  unsigned int code() const noexcept { return code_; }
+
+private:
+  std::string message_;
+  unsigned int code_;
+};
+
+// Bound output buffers for a statement's result columns
+struct ResultBuffers
+{
+  using NullFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+  std::vector<MYSQL_BIND> binds;
+  std::vector<std::vector<char>> data;
+  std::vector<unsigned long> lengths;
+  std::unique_ptr<NullFlag[]> nulls;
+};
+
+// Read access to the current row of an executing statement
+class ResultRow
+{
+public:
+  ResultRow(MYSQL_STMT *stmt, ResultBuffers &buffers) : stmt_(stmt), buffers_(buffers) {}
+
+  size_t size() const { return buffers_.binds.size(); }
+
+  bool isNull(size_t column) const { return buffers_.nulls[column]; }
+
+  int64_t getInt64(size_t column) const
+  {
+    if (isNull(column))
+    {
+      return 0;
+    }
+    int64_t value;
+    std::memcpy(&value, buffers_.data[column].data(), sizeof(value));
+    return value;
+  }
+
+  std::string getString(size_t column) const
+  {
+    if (isNull(column))
+    {
+      return std::string();
+    }
+
+    unsigned long length = buffers_.lengths[column];
+    if (length <= buffers_.data[column].size())
+    {
+      return std::string(buffers_.data[column].data(), length);
+    }
+
+    // The value was truncated into the bound buffer; fetch the full column
+    std::string value(length, '\0');
+    MYSQL_BIND bind;
+    std::memset(&bind, 0, sizeof(bind));
+    bind.buffer_type = MYSQL_TYPE_STRING;
+    bind.buffer = value.data();
+    bind.buffer_length = length;
+    if (mysql_stmt_fetch_column(stmt_, &bind, static_cast<unsigned int>(column), 0) != 0)
+    {
+      throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+    }
+    return value;
+  }
+
+private:
+  MYSQL_STMT *stmt_;
+  ResultBuffers &buffers_;
+};
+
+// A server-side prepared statement. Parameters are bound by C++ type;
+// integer result columns are read as BIGINT and everything else as strings.
+class Statement
+{
+public:
+  static constexpr size_t STRING_BUFFER_SIZE = 256;
+
+  Statement(MYSQL *conn, const std::string &sql, uint64_t &roundTrips) : roundTrips_(&roundTrips)
+  {
+    stmt_ = mysql_stmt_init(conn);
+    if (!stmt_)
+    {
+      throw DatabaseError(mysql_error(conn), mysql_errno(conn));
+    }
+    ++*roundTrips_;
+    if (mysql_stmt_prepare(stmt_, sql.data(), sql.size()) != 0)
+    {
+      DatabaseError error(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+      mysql_stmt_close(stmt_);
+      throw error;
+    }
+    paramCount_ = mysql_stmt_param_count(stmt_);
+
+    try
+    {
+      bindResultColumns();
+    }
+    catch (...)
+    {
+      mysql_stmt_close(stmt_);
+      throw;
+    }
+  }
+
+  Statement(const Statement &) = delete;
+  Statement &operator=(const Statement &) = delete;
+
+  ~Statement()
+  {
+    mysql_stmt_close(stmt_);
+  }
+
+  // Execute with the given parameters, discarding any result set
+  template <typename... Args>
+  void execute(const Args &...args)
+  {
+    run(args...);
+    mysql_stmt_free_result(stmt_);
+  }
+
+  // Execute and stream result rows to fn without buffering the result set.
+  // fn may return false to stop early.
+  template <typename Fn, typename... Args>
+  void forEach(Fn &&fn, const Args &...args)
+  {
+    run(args...);
+    fetchAll(std::forward<Fn>(fn));
+  }
+
+  // Execute with a runtime-sized list of string parameters, for statements
+  // whose placeholder count depends on the input (multi-row INSERT, IN lists)
+  void executeStrings(const std::vector<std::string_view> &params)
+  {
+    runStrings(params);
+    mysql_stmt_free_result(stmt_);
+  }
+
+  template <typename Fn>
+  void forEachStrings(Fn &&fn, const std::vector<std::string_view> &params)
+  {
+    runStrings(params);
+    fetchAll(std::forward<Fn>(fn));
+  }
+
+  uint64_t affectedRows() const
+  {
+    return mysql_stmt_affected_rows(stmt_);
+  }
+
+  uint64_t insertId() const
+  {
+    return mysql_stmt_insert_id(stmt_);
+  }
+
+private:
+  MYSQL_STMT *stmt_ = nullptr;
+  uint64_t *roundTrips_;
+  unsigned long paramCount_ = 0;
+  ResultBuffers result_;
+
+  struct ParamStorage
+  {
+    unsigned long length = 0;
+  };
+
+  void bindResultColumns()
+  {
+    MYSQL_RES *meta = mysql_stmt_result_metadata(stmt_);
+    if (!meta)
+    {
+      return;
+    }
+
+    unsigned int count = mysql_num_fields(meta);
+    MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+
+    result_.binds.resize(count);
+    result_.data.resize(count);
+    result_.lengths.assign(count, 0);
+    result_.nulls = std::make_unique<ResultBuffers::NullFlag[]>(count);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      auto &bind = result_.binds[i];
+      std::memset(&bind, 0, sizeof(bind));
+
+      switch (fields[i].type)
+      {
+      case MYSQL_TYPE_TINY:
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_LONG:
+      case MYSQL_TYPE_LONGLONG:
+        result_.data[i].resize(sizeof(int64_t));
+        bind.buffer_type = MYSQL_TYPE_LONGLONG;
+        break;
+      default:
+        result_.data[i].resize(STRING_BUFFER_SIZE);
+        bind.buffer_type = MYSQL_TYPE_STRING;
+        break;
+      }
+
+      bind.buffer = result_.data[i].data();
+      bind.buffer_length = result_.data[i].size();
+      bind.length = &result_.lengths[i];
+      bind.is_null = &result_.nulls[i];
+    }
+
+    mysql_free_result(meta);
+
+    if (mysql_stmt_bind_result(stmt_, result_.binds.data()) != 0)
+    {
+      throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+    }
+  }
+
+  template <typename Fn>
+  void fetchAll(Fn &&fn)
+  {
+    struct FreeResult
+    {
+      MYSQL_STMT *stmt;
+      ~FreeResult() { mysql_stmt_free_result(stmt); }
+    } guard{stmt_};
+
+    ResultRow row(stmt_, result_);
+    while (true)
+    {
+      int status = mysql_stmt_fetch(stmt_);
+      if (status == MYSQL_NO_DATA)
+      {
+        break;
+      }
+      // MYSQL_DATA_TRUNCATED is fine: ResultRow refetches long columns
+      if (status == 1)
+      {
+        throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+      }
+
+      if constexpr (std::is_same_v<std::invoke_result_t<Fn, ResultRow &>, bool>)
+      {
+        // Freeing the result discards any rows left unread
+        if (!fn(row))
+        {
+          break;
+        }
+      }
+      else
+      {
+        fn(row);
+      }
+    }
+  }
+
+  void runStrings(const std::vector<std::string_view> &params)
+  {
+    if (params.size() != paramCount_)
+    {
+      throw DatabaseError("Prepared statement expects " + std::to_string(paramCount_) + " parameters");
+    }
+
+    std::vector<MYSQL_BIND> binds(params.size());
+    std::vector<unsigned long> lengths(params.size());
+    if (!binds.empty())
+    {
+      std::memset(binds.data(), 0, sizeof(MYSQL_BIND) * binds.size());
+    }
+
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+      lengths[i] = params[i].size();
+      binds[i].buffer_type = MYSQL_TYPE_STRING;
+      binds[i].buffer = const_cast<char *>(params[i].data());
+      binds[i].buffer_length = params[i].size();
+      binds[i].length = &lengths[i];
+    }
+
+    if (!binds.empty() && mysql_stmt_bind_param(stmt_, binds.data()) != 0)
+    {
+      throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+    }
+    ++*roundTrips_;
+    if (mysql_stmt_execute(stmt_) != 0)
+    {
+      throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+    }
+  }
+
+  template <typename... Args>
+  void run(const Args &...args)
+  {
+    if (sizeof...(Args) != paramCount_)
+    {
+      throw DatabaseError("Prepared statement expects " + std::to_string(paramCount_) + " parameters");
+    }
+
+    if constexpr (sizeof...(Args) > 0)
+    {
+      std::array<MYSQL_BIND, sizeof...(Args)> binds;
+      std::array<ParamStorage, sizeof...(Args)> storage;
+      std::memset(binds.data(), 0, sizeof(MYSQL_BIND) * binds.size());
+
+      size_t index = 0;
+      ((bindParam(binds[index], storage[index], args), ++index), ...);
+
+      if (mysql_stmt_bind_param(stmt_, binds.data()) != 0)
+      {
+        throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+      }
+    }
+
+    ++*roundTrips_;
+    if (mysql_stmt_execute(stmt_) != 0)
+    {
+      throw DatabaseError(mysql_stmt_error(stmt_), mysql_stmt_errno(stmt_));
+    }
+  }
+
+  template <typename T>
+  static void bindParam(MYSQL_BIND &bind, ParamStorage &storage, const T &value)
+  {
+    if constexpr (std::is_integral_v<T> && sizeof(T) == sizeof(int64_t))
+    {
+      bind.buffer_type = MYSQL_TYPE_LONGLONG;
+      bind.buffer = const_cast<T *>(&value);
+      bind.is_unsigned = std::is_unsigned_v<T>;
+    }
+    else if constexpr (std::is_integral_v<T> && sizeof(T) == sizeof(int32_t))
+    {
+      bind.buffer_type = MYSQL_TYPE_LONG;
+      bind.buffer = const_cast<T *>(&value);
+      bind.is_unsigned = std::is_unsigned_v<T>;
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+      storage.length = value.size();
+      bind.buffer_type = MYSQL_TYPE_STRING;
+      bind.buffer = const_cast<char *>(value.data());
+      bind.buffer_length = value.size();
+      bind.length = &storage.length;
+    }
+    else
+    {
+      static_assert(sizeof(T) == 0, "Unsupported prepared statement parameter type");
+    }
+  }
+};
+
+// One MySQL client connection with its own cache of prepared statements
+class DatabaseConnection
+{
+public:
+  DatabaseConnection()
+  {
+    // mysql_init would do this lazily, but that is not thread-safe
+    static std::once_flag libraryInit;
+    std::call_once(libraryInit, []
+                   { mysql_library_init(0, nullptr, nullptr); });
+
+    conn_ = mysql_init(nullptr);
+    if (!conn_)
+    {
+      throw DatabaseError("Could not allocate MySQL handle");
+    }
+  }
+
+  DatabaseConnection(const DatabaseConnection &) = delete;
+  DatabaseConnection &operator=(const DatabaseConnection &) = delete;
+
+  ~DatabaseConnection()
+  {
+    // Statements must be closed before their connection
+    statements_.clear();
+    mysql_close(conn_);
+  }
+
+  bool connect(const char *host, const char *user, const char *password, const char *database, int port)
+  {
+    // CLIENT_FOUND_ROWS makes affected rows count matched rows, so an UPDATE
+    // that leaves a row unchanged is still distinguishable from a missing row
+    return mysql_real_connect(conn_, host, user, password, database, static_cast<unsigned int>(port),
+                              nullptr, CLIENT_FOUND_ROWS) != nullptr;
+  }
+
+  // Open a connection with the configured MySQL credentials
+  static std::unique_ptr<DatabaseConnection> open()
+  {
+    auto db = std::make_unique<DatabaseConnection>();
+    bool connected = db->connect(
+        Config::AppConfig::getMySQLHost(),
+        Config::AppConfig::getMySQLUser(),
+        Config::AppConfig::getMySQLPassword(),
+        Config::AppConfig::getMySQLDatabase(),
+        Config::AppConfig::getMySQLPort());
+
+    if (!connected)
+    {
+      throw DatabaseError("Could not connect to MySQL: " + db->lastError(), mysql_errno(db->conn_));
+    }
+    return db;
+  }
+
+  // Run a statement that takes no parameters, such as DDL or transaction control
+  void execute(const std::string &sql)
+  {
+    ++roundTrips_;
+    if (mysql_real_query(conn_, sql.data(), sql.size()) != 0)
+    {
+      DatabaseError error(mysql_error(conn_), mysql_errno(conn_));
+      markIfLost(error);
+      throw error;
+    }
+
+    if (MYSQL_RES *result = mysql_store_result(conn_))
+    {
+      mysql_free_result(result);
+    }
+  }
+
+  bool ping()
+  {
+    if (broken_)
+    {
+      return false;
+    }
+    ++roundTrips_;
+    return mysql_ping(conn_) == 0;
+  }
+
+  // Prepared once per connection, then reused for every later call
+  Statement &prepare(const std::string &sql)
+  {
+    auto it = statements_.find(sql);
+    if (it != statements_.end())
+    {
+      return *it->second;
+    }
+
+    try
+    {
+      auto stmt = std::make_unique<Statement>(conn_, sql, roundTrips_);
+      auto &ref = *stmt;
+      statements_.emplace(sql, std::move(stmt));
+      return ref;
+    }
+    catch (const DatabaseError &e)
+    {
+      markIfLost(e);
+      throw;
+    }
+  }
+
+  // Run fn against a cached statement, flagging the connection if the server went away
+  template <typename Fn>
+  auto with(const std::string &sql, Fn &&fn)
+  {
+    auto &stmt = prepare(sql);
+    try
+    {
+      return fn(stmt);
+    }
+    catch (const DatabaseError &e)
+    {
+      markIfLost(e);
+      throw;
+    }
+  }
+
+  // Run fn against a statement that is prepared for this call only, for SQL
+  // that varies too much to be worth keeping in the cache
+  template <typename Fn>
+  auto withUncached(const std::string &sql, Fn &&fn)
+  {
+    try
+    {
+      Statement stmt(conn_, sql, roundTrips_);
+      return fn(stmt);
+    }
+    catch (const DatabaseError &e)
+    {
+      markIfLost(e);
+      throw;
+    }
+  }
+
+  // @@auto_increment_increment, the step between the ids of one multi-row
+  // INSERT; read on first use, since this code never changes it
+  int64_t autoIncrementIncrement()
+  {
+    if (autoIncrementIncrement_ == 0)
+    {
+      autoIncrementIncrement_ = withUncached("SELECT @@auto_increment_increment", [](Statement &stmt)
+                                             {
+        int64_t increment = 1;
+        stmt.forEach([&increment](ResultRow &row)
+                     { increment = row.getInt64(0); });
+        return increment; });
+    }
+    return autoIncrementIncrement_;
+  }
+
+  // Requests sent to the server so far: queries, prepares, executes and pings
+  uint64_t roundTrips() const
+  {
+    return roundTrips_;
+  }
+
+  bool broken() const
+  {
+    return broken_;
+  }
+
+  std::string lastError()
+  {
+    return mysql_error(conn_);
+  }
+
+private:
+  MYSQL *conn_ = nullptr;
+  std::unordered_map<std::string, std::unique_ptr<Statement>> statements_;
+  bool broken_ = false;
+  uint64_t roundTrips_ = 0;
+  int64_t autoIncrementIncrement_ = 0;
+
+  void markIfLost(const DatabaseError &e)
+  {
+    // CR_SERVER_GONE_ERROR, CR_SERVER_LOST
+    if (e.code() == 2006 || e.code() == 2013)
+    {
+      broken_ = true;
+    }
+  }
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "crow.h"
+#include <memory>
+#include <mutex>
+#include "../config/config.hpp"
+#include "../controllers/BaseController.hpp"
+#include "../utils/WorkerPool.hpp"
+
+// Runs blocking MySQL work on a dedicated worker pool so the Crow I/O
+// threads stay free for routes that never touch the database.
+class DatabaseExecutor : public Controllers::BaseController
+{
+public:
+  static void init(size_t threads, size_t queueSize)
+  {
+    auto &executor = instance();
+    std::lock_guard<std::mutex> lock(executor.mtx_);
+    if (!executor.pool_)
+    {
+      executor.pool_ = std::make_unique<WorkerPool>("Database executor", threads, queueSize);
+    }
+  }
+
+  // Apply new thread and queue sizes, e.g. after a config reload
+  static void resize(size_t threads, size_t queueSize)
+  {
+    pool().resize(threads, queueSize);
+  }
+
+  // Run fn on a database worker; throws QueueFullError when the executor is saturated
+  template <typename F>
+  static auto submit(F &&fn)
+  {
+    return pool().submit(std::forward<F>(fn));
+  }
+
+  // Run a handler that produces a crow::response on a database worker and
+  // complete res with it. Crow keeps the request alive until res.end().
+  // A handler may instead return std::optional<crow::response>: std::nullopt
+  // means it passed res on, e.g. to PasswordHasher::respond.
+  template <typename F>
+  static void respond(crow::response &res, F &&handler)
+  {
+    bool queued = pool().post([&res, handler = std::forward<F>(handler)]() mutable
+                              {
+      try
+      {
+        complete(res, handler());
+      }
+      catch (const std::exception &e)
+      {
+        complete(res, server_error(e.what()));
+      } });
+
+    if (!queued)
+    {
+      complete(res, service_unavailable("Database is busy, try again later"));
+    }
+  }
+
+  static void shutdown()
+  {
+    auto &executor = instance();
+    std::lock_guard<std::mutex> lock(executor.mtx_);
+    if (executor.pool_)
+    {
+      executor.pool_->shutdown();
+    }
+  }
+
+private:
+  std::unique_ptr<WorkerPool> pool_;
+  std::mutex mtx_;
+
+  static DatabaseExecutor &instance()
+  {
+    static DatabaseExecutor instance;
+    return instance;
+  }
+
+  static WorkerPool &pool()
+  {
+    auto &executor = instance();
+    {
+      std::lock_guard<std::mutex> lock(executor.mtx_);
+      if (executor.pool_)
+      {
+        return *executor.pool_;
+      }
+    }
+    init(Config::AppConfig::getDBExecutorThreads(), Config::AppConfig::getDBExecutorQueueSize());
+    return *executor.pool_;
+  }
+};
@@ -6,6 +6,7 @@
 
 // Include your migration headers
 #include "migrations/CreateUsersTable.hpp"
+#include "migrations/AddUsersEmailIndex.hpp"
 
 class MigrationManager
 {
@@ -16,8 +17,9 @@ public:
 
     // Create an array of migration functions
     std::vector<void (*)()> migrations = {
-        migrate, // Call CreateUsersTable::migrate()
-                 // Add more migration functions here as needed...
+        migrate,            // Call CreateUsersTable::migrate()
+        addUsersEmailIndex, // Unique index for login lookups
+                            // Add more migration functions here as needed...
     };
 
     // Execute each migration
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include "DatabaseConnection.hpp"
+
+// Per-endpoint count of MySQL round trips, so changes to a handler's query
+// pattern show up in /api/users/stats and the X-DB-Round-Trips header
+class RoundTripStats
+{
+public:
+  // Counts the round trips made on db between construction and destruction,
+  // plus any already made on other connections for the same request
+  class Scope
+  {
+  public:
+    Scope(DatabaseConnection &db, std::string endpoint, uint64_t earlier = 0)
+        : db_(db), endpoint_(std::move(endpoint)), start_(db.roundTrips()), earlier_(earlier) {}
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    ~Scope()
+    {
+      RoundTripStats::record(endpoint_, count());
+    }
+
+    uint64_t count() const
+    {
+      return earlier_ + db_.roundTrips() - start_;
+    }
+
+  private:
+    DatabaseConnection &db_;
+    std::string endpoint_;
+    uint64_t start_;
+    uint64_t earlier_;
+  };
+
+  static void record(const std::string &endpoint, uint64_t roundTrips)
+  {
+    auto &stats = instance();
+    std::lock_guard<std::mutex> lock(stats.mtx_);
+    auto &entry = stats.endpoints_[endpoint];
+    entry.requests++;
+    entry.roundTrips += roundTrips;
+  }
+
+  static nlohmann::json snapshot()
+  {
+    auto &stats = instance();
+    std::lock_guard<std::mutex> lock(stats.mtx_);
+
+    nlohmann::json result = nlohmann::json::object();
+    for (const auto &[endpoint, entry] : stats.endpoints_)
+    {
+      result[endpoint] = {{"requests", entry.requests},
+                          {"round_trips", entry.roundTrips},
+                          {"per_request", entry.requests ? static_cast<double>(entry.roundTrips) / entry.requests : 0.0}};
+    }
+    return result;
+  }
+
+private:
+  struct Entry
+  {
+    uint64_t requests = 0;
+    uint64_t roundTrips = 0;
+  };
+
+  std::mutex mtx_;
+  std::map<std::string, Entry> endpoints_;
+
+  static RoundTripStats &instance()
+  {
+    static RoundTripStats instance;
+    return instance;
+  }
+};
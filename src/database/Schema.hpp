@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "DatabaseConnection.hpp"
+#include "../utils/StringUtils.hpp"
+
+// A secondary or unique index declared by a migration. Columns may carry a
+// prefix length, e.g. "email(191)", which MySQL requires for TEXT columns.
+struct IndexDefinition
+{
+  std::string table;
+  std::string name;
+  std::vector<std::string> columns;
+  bool unique = false;
+};
+
+class Schema
+{
+public:
+  static bool hasIndex(DatabaseConnection &db, const std::string &table, const std::string &name)
+  {
+    int64_t count = 0;
+    db.with("SELECT COUNT(*) FROM information_schema.statistics "
+            "WHERE table_schema = DATABASE() AND table_name = ? AND index_name = ?",
+            [&](Statement &stmt)
+            { stmt.forEach([&](ResultRow &row)
+                           { count = row.getInt64(0); }, table, name); });
+    return count > 0;
+  }
+
+  // Create the index unless it already exists; returns false when it was already there
+  static bool createIndex(DatabaseConnection &db, const IndexDefinition &index)
+  {
+    if (hasIndex(db, index.table, index.name))
+    {
+      return false;
+    }
+
+    std::string sql = std::string("CREATE ") + (index.unique ? "UNIQUE " : "") +
+                      "INDEX `" + index.name + "` ON `" + index.table + "` (" +
+                      StringUtils::join(index.columns, ", ") + ")";
+    db.execute(sql);
+    return true;
+  }
+};
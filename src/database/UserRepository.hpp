@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "DatabaseConnection.hpp"
+#include "../models/User.hpp"
+
+// Fixed User queries, run as prepared statements cached on each pooled connection
+class UserRepository
+{
+public:
+  static std::optional<User> findById(DatabaseConnection &db, int64_t id)
+  {
+    return findOne(db, "SELECT id, name, email, password FROM users WHERE id = ?", id);
+  }
+
+  static std::optional<User> findByEmail(DatabaseConnection &db, const std::string &email)
+  {
+    return findOne(db, "SELECT id, name, email, password FROM users WHERE email = ? LIMIT 1", email);
+  }
+
+  static std::vector<User> all(DatabaseConnection &db)
+  {
+    std::vector<User> users;
+    db.with("SELECT id, name, email, password FROM users ORDER BY id", [&](Statement &stmt)
+            { stmt.forEach([&](ResultRow &row)
+                           { users.push_back(toUser(row)); }); });
+    return users;
+  }
+
+  // Stream every user in id order without buffering the result set.
+  // The connection cannot run other statements until fn has seen every row.
+  template <typename Fn>
+  static void forEach(DatabaseConnection &db, Fn &&fn)
+  {
+    db.with("SELECT id, name, email FROM users ORDER BY id", [&](Statement &stmt)
+            { stmt.forEach([&](ResultRow &row)
+                           {
+        User user;
+        user.id = row.getInt64(0);
+        user.name = row.getString(1);
+        user.email = row.getString(2);
+        fn(user); }); });
+  }
+
+  // Keyset page: up to limit users with id greater than afterId, in id order
+  static std::vector<User> page(DatabaseConnection &db, int64_t afterId, int64_t limit)
+  {
+    std::vector<User> users;
+    users.reserve(static_cast<size_t>(limit));
+    db.with("SELECT id, name, email, password FROM users WHERE id > ? ORDER BY id LIMIT ?", [&](Statement &stmt)
+            { stmt.forEach([&](ResultRow &row)
+                           { users.push_back(toUser(row)); }, afterId, limit); });
+    return users;
+  }
+
+  // Returns the generated id
+  static int64_t insert(DatabaseConnection &db, const User &user)
+  {
+    return db.with("INSERT INTO users (name, email, password) VALUES (?, ?, ?)", [&](Statement &stmt)
+                   {
+      stmt.execute(user.name, user.email, user.password);
+      return static_cast<int64_t>(stmt.insertId()); });
+  }
+
+  // Insert all users with one multi-row INSERT and return the id generated for
+  // the first row. InnoDB assigns a "simple insert" (row count known up front)
+  // a consecutive block of ids, so users[i] received first + i.
+  static int64_t insertBatch(DatabaseConnection &db, const std::vector<const User *> &users)
+  {
+    std::vector<std::string_view> params;
+    params.reserve(users.size() * 3);
+    for (const auto *user : users)
+    {
+      params.push_back(user->name);
+      params.push_back(user->email);
+      params.push_back(user->password);
+    }
+
+    auto sql = "INSERT INTO users (name, email, password) VALUES " + placeholders("(?, ?, ?)", users.size());
+    auto run = [&](Statement &stmt)
+    {
+      stmt.executeStrings(params);
+      return static_cast<int64_t>(stmt.insertId());
+    };
+
+    // Full batches share one cached statement; the odd-sized tail is prepared once
+    return users.size() == BULK_BATCH_SIZE ? db.with(sql, run) : db.withUncached(sql, run);
+  }
+
+  // Which of the given emails are already registered, as stored in the table
+  static std::unordered_set<std::string> existingEmails(DatabaseConnection &db, const std::vector<std::string_view> &emails)
+  {
+    std::unordered_set<std::string> found;
+    for (size_t offset = 0; offset < emails.size(); offset += BULK_BATCH_SIZE)
+    {
+      size_t count = std::min(BULK_BATCH_SIZE, emails.size() - offset);
+      std::vector<std::string_view> params(emails.begin() + offset, emails.begin() + offset + count);
+      auto sql = "SELECT email FROM users WHERE email IN (" + placeholders("?", count) + ")";
+      auto run = [&](Statement &stmt)
+      {
+        stmt.forEachStrings([&](ResultRow &row)
+                            { found.insert(row.getString(0)); }, params);
+      };
+
+      if (count == BULK_BATCH_SIZE)
+      {
+        db.with(sql, run);
+      }
+      else
+      {
+        db.withUncached(sql, run);
+      }
+    }
+    return found;
+  }
+
+  // Returns the number of rows matched, changed or not (CLIENT_FOUND_ROWS)
+  static uint64_t update(DatabaseConnection &db, const User &user)
+  {
+    return db.with("UPDATE users SET name = ?, email = ?, password = ? WHERE id = ?", [&](Statement &stmt)
+                   {
+      stmt.execute(user.name, user.email, user.password, user.id);
+      return stmt.affectedRows(); });
+  }
+
+  // Store a new password hash, e.g. after the KDF parameters changed
+  static uint64_t updatePassword(DatabaseConnection &db, int64_t id, const std::string &password)
+  {
+    return db.with("UPDATE users SET password = ? WHERE id = ?", [&](Statement &stmt)
+                   {
+      stmt.execute(password, id);
+      return stmt.affectedRows(); });
+  }
+
+  // Returns the number of rows deleted
+  static uint64_t remove(DatabaseConnection &db, int64_t id)
+  {
+    return db.with("DELETE FROM users WHERE id = ?", [&](Statement &stmt)
+                   {
+      stmt.execute(id);
+      return stmt.affectedRows(); });
+  }
+
+  static User toUser(ResultRow &row)
+  {
+    User user;
+    user.id = row.getInt64(0);
+    user.name = row.getString(1);
+    user.email = row.getString(2);
+    user.password = row.getString(3);
+    return user;
+  }
+
+  // Rows per multi-row INSERT or IN list, keeping packets well under max_allowed_packet
+  static constexpr size_t BULK_BATCH_SIZE = 500;
+
+private:
+  // group repeated count times, comma separated: "(?, ?, ?), (?, ?, ?)"
+  static std::string placeholders(const std::string &group, size_t count)
+  {
+    std::string sql;
+    sql.reserve((group.size() + 2) * count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (i > 0)
+      {
+        sql += ", ";
+      }
+      sql += group;
+    }
+    return sql;
+  }
+
+  template <typename Param>
+  static std::optional<User> findOne(DatabaseConnection &db, const std::string &sql, const Param &param)
+  {
+    std::optional<User> user;
+    db.with(sql, [&](Statement &stmt)
+            { stmt.forEach([&](ResultRow &row)
+                           {
+        user = toUser(row);
+        return false; }, param); });
+    return user;
+  }
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include "../DatabaseConnection.hpp"
+#include "../Schema.hpp"
+#include <iostream>
+
+void addUsersEmailIndex()
+{
+  try
+  {
+    auto db = DatabaseConnection::open();
+
+    // Login looks users up by email. ormpp creates string columns as TEXT,
+    // which needs a prefix length; 191 characters covers real addresses.
+    bool created = Schema::createIndex(*db, {"users", "users_email_unique", {"email(191)"}, true});
+
+    if (created)
+    {
+      std::cout << "Migration completed: Unique index on users.email created successfully." << std::endl;
+    }
+    else
+    {
+      std::cout << "Migration skipped: Index on users.email already exists." << std::endl;
+    }
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << "Migration error: " << e.what() << std::endl;
+  }
+}
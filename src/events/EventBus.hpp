@@ -0,0 +1,337 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../redis/RedisManager.hpp"
+#include "../utils/WorkerPool.hpp"
+
+namespace Events
+{
+  // Redis pub/sub for the whole process: one subscriber connection serves
+  // every registered channel and pattern, and handlers run on a bounded
+  // WorkerPool rather than on the subscriber thread.
+  //
+  // Messages on one channel are handled one at a time, in publish order;
+  // different channels proceed in parallel, so a slow handler only holds up
+  // its own channel. Register handlers before start().
+  class EventBus
+  {
+  public:
+    using Handler = std::function<void(const std::string &channel, const std::string &message)>;
+    // Runs on the subscriber thread once Redis confirms each (re)subscription,
+    // so state rebuilt there cannot miss a message published afterwards
+    using SubscribedHandler = std::function<void()>;
+
+    EventBus(size_t threads, size_t queueCapacity, size_t maxPendingPerChannel)
+        : pool_("Event bus", threads, queueCapacity), maxPending_(maxPendingPerChannel) {}
+
+    EventBus(const EventBus &) = delete;
+    EventBus &operator=(const EventBus &) = delete;
+
+    ~EventBus()
+    {
+      stop();
+      pool_.shutdown();
+    }
+
+    void on(const std::string &channel, Handler handler, SubscribedHandler onSubscribed = nullptr)
+    {
+      auto &subscription = channels_[channel];
+      subscription.handlers.push_back(std::move(handler));
+      if (onSubscribed)
+      {
+        subscription.onSubscribed.push_back(std::move(onSubscribed));
+      }
+    }
+
+    // Typed handler: the message is parsed as JSON and converted with
+    // nlohmann's from_json; messages that do not convert are logged and skipped
+    template <typename Event, typename F>
+    void on(const std::string &channel, F handler)
+    {
+      on(channel, [this, handler = std::move(handler)](const std::string &name, const std::string &message)
+         {
+        Event event;
+        try
+        {
+          event = nlohmann::json::parse(message).get<Event>();
+        }
+        catch (const std::exception &e)
+        {
+          malformed_++;
+          std::cerr << "[Events] Bad message on '" << name << "': " << e.what() << std::endl;
+          return;
+        }
+        handler(event); });
+    }
+
+    // Glob-style pattern as in PSUBSCRIBE, e.g. "user-*"
+    void onPattern(const std::string &pattern, Handler handler)
+    {
+      patterns_[pattern].handlers.push_back(std::move(handler));
+    }
+
+    void start()
+    {
+      if (!running_.load() && !(channels_.empty() && patterns_.empty()))
+      {
+        running_.store(true);
+        worker_ = std::thread(&EventBus::run, this);
+      }
+    }
+
+    // Stops receiving; messages already queued are still handled
+    void stop()
+    {
+      running_.store(false);
+      if (worker_.joinable())
+      {
+        worker_.join();
+      }
+    }
+
+    bool isRunning() const { return running_.load(); }
+
+    nlohmann::json stats() const
+    {
+      return {{"received", received_.load()},
+              {"handled", handled_.load()},
+              {"dropped", dropped_.load()},
+              {"handler_errors", errors_.load()},
+              {"malformed", malformed_.load()},
+              {"inline_drains", inlineDrains_.load()},
+              {"queued_tasks", pool_.queued()}};
+    }
+
+  private:
+    struct Subscription
+    {
+      std::vector<Handler> handlers;
+      std::vector<SubscribedHandler> onSubscribed;
+    };
+
+    struct Message
+    {
+      const std::vector<Handler> *handlers = nullptr;
+      std::string channel;
+      std::string payload;
+    };
+
+    // Pending messages of one channel; at most one drain task runs per strand
+    struct Strand
+    {
+      std::deque<Message> pending;
+      bool scheduled = false;
+    };
+
+    static constexpr int MAX_RECONNECT_DELAY_MS = 30000;
+    static constexpr int INITIAL_RECONNECT_DELAY_MS = 1000;
+    // Messages one drain task handles before yielding its worker to other channels
+    static constexpr size_t DRAIN_BATCH = 64;
+
+    // Fixed once start() runs, so handler addresses stay valid
+    std::map<std::string, Subscription> channels_;
+    std::map<std::string, Subscription> patterns_;
+
+    WorkerPool pool_;
+    size_t maxPending_;
+    std::mutex strandsMtx_;
+    std::unordered_map<std::string, Strand> strands_;
+
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> handled_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> malformed_{0};
+    std::atomic<uint64_t> inlineDrains_{0};
+
+    void dispatch(const std::vector<Handler> &handlers, const std::string &channel, std::string payload)
+    {
+      received_++;
+      Strand *strand;
+      {
+        std::lock_guard<std::mutex> lock(strandsMtx_);
+        strand = &strands_[channel];
+        if (strand->pending.size() >= maxPending_)
+        {
+          dropped_++;
+          std::cerr << "[Events] Dropped a message on '" << channel << "': handlers are behind" << std::endl;
+          return;
+        }
+        strand->pending.push_back({&handlers, channel, std::move(payload)});
+        if (strand->scheduled)
+        {
+          return;
+        }
+        strand->scheduled = true;
+      }
+      schedule(*strand);
+    }
+
+    void schedule(Strand &strand)
+    {
+      if (!pool_.post([this, &strand]
+                      { drain(strand); }))
+      {
+        // A full pool pushes back on the caller instead of stalling the strand
+        inlineDrains_++;
+        drain(strand);
+      }
+    }
+
+    void drain(Strand &strand)
+    {
+      for (size_t handled = 0;; ++handled)
+      {
+        Message message;
+        {
+          std::lock_guard<std::mutex> lock(strandsMtx_);
+          if (strand.pending.empty())
+          {
+            strand.scheduled = false;
+            return;
+          }
+          if (handled == DRAIN_BATCH)
+          {
+            // Requeue behind other channels' work, or carry on if the pool is full
+            if (pool_.post([this, &strand]
+                           { drain(strand); }))
+            {
+              return;
+            }
+            inlineDrains_++;
+            handled = 0;
+          }
+          message = std::move(strand.pending.front());
+          strand.pending.pop_front();
+        }
+
+        for (const auto &handler : *message.handlers)
+        {
+          try
+          {
+            handler(message.channel, message.payload);
+          }
+          catch (const std::exception &e)
+          {
+            errors_++;
+            std::cerr << "[Events] Handler failed on '" << message.channel << "': " << e.what() << std::endl;
+          }
+          catch (...)
+          {
+            errors_++;
+          }
+        }
+        handled_++;
+      }
+    }
+
+    void run()
+    {
+      int reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
+
+      while (running_.load())
+      {
+        try
+        {
+          auto sub = RedisManager().getRedis()->subscriber();
+
+          sub.on_message([this](std::string channel, std::string msg)
+                         {
+            auto it = channels_.find(channel);
+            if (it != channels_.end())
+            {
+              dispatch(it->second.handlers, channel, std::move(msg));
+            } });
+
+          sub.on_pmessage([this](std::string pattern, std::string channel, std::string msg)
+                          {
+            auto it = patterns_.find(pattern);
+            if (it != patterns_.end())
+            {
+              dispatch(it->second.handlers, channel, std::move(msg));
+            } });
+
+          sub.on_meta([this](sw::redis::Subscriber::MsgType type, sw::redis::OptionalString channel, long long)
+                      {
+            if (type != sw::redis::Subscriber::MsgType::SUBSCRIBE || !channel)
+            {
+              return;
+            }
+            auto it = channels_.find(*channel);
+            if (it != channels_.end())
+            {
+              for (const auto &callback : it->second.onSubscribed)
+              {
+                callback();
+              }
+            } });
+
+          std::vector<std::string> channels;
+          for (const auto &entry : channels_)
+          {
+            channels.push_back(entry.first);
+          }
+          std::vector<std::string> patterns;
+          for (const auto &entry : patterns_)
+          {
+            patterns.push_back(entry.first);
+          }
+          if (!channels.empty())
+          {
+            sub.subscribe(channels.begin(), channels.end());
+          }
+          if (!patterns.empty())
+          {
+            sub.psubscribe(patterns.begin(), patterns.end());
+          }
+
+          // Reset delay on successful connection
+          reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
+          std::cout << "[Events] Subscribed to " << channels.size() << " channels and "
+                    << patterns.size() << " patterns" << std::endl;
+
+          // Use consume with timeout to allow checking running_ flag
+          while (running_.load())
+          {
+            try
+            {
+              sub.consume();
+            }
+            catch (const sw::redis::TimeoutError &)
+            {
+              // Timeout is expected, continue loop to check running_ flag
+            }
+          }
+        }
+        catch (const sw::redis::Error &e)
+        {
+          if (running_.load())
+          {
+            std::cerr << "[Events] Redis error: " << e.what()
+                      << ". Reconnecting in " << reconnectDelay << "ms..." << std::endl;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(reconnectDelay));
+
+            // Exponential backoff with max limit
+            reconnectDelay = std::min(reconnectDelay * 2, MAX_RECONNECT_DELAY_MS);
+          }
+        }
+      }
+    }
+  };
+}
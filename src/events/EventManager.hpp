@@ -1,27 +1,61 @@
 #pragma once
 #include "logEvent.hpp"
+#include "EventBus.hpp"
+#include "EventStream.hpp"
+#include "../auth/RevocationList.hpp"
+#include "../cache/UserCache.hpp"
+#include "../config/config.hpp"
 
 namespace Events
 {
+  // Wires each module's channel handlers into one EventBus. Log events can
+  // also go through a durable stream, where each entry is handled by one node.
   class EventManager
   {
   private:
-    LogEventSubscriber logSubscriber_;
+    // Declared before bus_ so it outlives the handlers still draining at shutdown
+    LogEventHandler logHandler_;
+    EventBus bus_{static_cast<size_t>(Config::AppConfig::getEventThreads()),
+                  static_cast<size_t>(Config::AppConfig::getEventQueueSize()),
+                  static_cast<size_t>(Config::AppConfig::getEventChannelPending())};
+    EventStream logStream_{LogEventHandler::STREAM, "api",
+                           [this](const std::string &stream, const std::string &msg)
+                           { logHandler_(stream, msg); }};
 
   public:
+    EventManager()
+    {
+      bus_.on(LogEventHandler::CHANNEL, [this](const std::string &channel, const std::string &msg)
+              { logHandler_(channel, msg); });
+      bus_.on(Cache::UserCache::INVALIDATION_CHANNEL, [](const std::string &, const std::string &msg)
+              { Cache::UserCache::handleInvalidationMessage(msg); });
+      bus_.on(
+          Auth::RevocationList::CHANNEL, [](const std::string &, const std::string &msg)
+          { Auth::RevocationList::handleMessage(msg); },
+          []
+          { Auth::RevocationList::load(); });
+    }
+
     void start()
     {
-      logSubscriber_.start();
+      bus_.start();
+      logStream_.start();
     }
 
     void stop()
     {
-      logSubscriber_.stop();
+      logStream_.stop();
+      bus_.stop();
     }
 
     bool isRunning() const
     {
-      return logSubscriber_.isRunning();
+      return bus_.isRunning() && logStream_.isRunning();
+    }
+
+    nlohmann::json stats() const
+    {
+      return {{"bus", bus_.stats()}, {"log_stream", logStream_.stats()}};
     }
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../config/config.hpp"
+#include "../redis/RedisManager.hpp"
+
+namespace Events
+{
+  // Durable work queue on a Redis Stream, consumed through a consumer group.
+  //
+  // Unlike pub/sub, entries published while no consumer is connected wait in
+  // the stream, and each entry goes to one consumer of the group, so every API
+  // node can run a consumer and share the work. Entries are acknowledged in one
+  // XACK per batch once handled; entries left pending by a consumer that died
+  // are claimed by another after EVENT_STREAM_RECLAIM_IDLE_MS. Delivery is at
+  // least once: a consumer that dies between handling and XACK causes a retry.
+  //
+  // Only for work one node should do. Broadcasts every node must see, such as
+  // cache invalidations, stay on pub/sub.
+  class EventStream
+  {
+  public:
+    using Handler = std::function<void(const std::string &stream, const std::string &payload)>;
+
+    // Entries are stored under this field
+    static constexpr const char *FIELD = "data";
+
+    // Append to the stream, trimming it to about EVENT_STREAM_MAXLEN entries;
+    // throws sw::redis::Error
+    static std::string publish(const std::string &stream, const std::string &payload)
+    {
+      std::vector<std::pair<std::string, std::string>> attrs = {{FIELD, payload}};
+      return RedisManager().getRedis()->xadd(stream, "*", attrs.begin(), attrs.end(),
+                                             Config::AppConfig::getEventStreamMaxLen(), true);
+    }
+
+    EventStream(std::string stream, std::string group, Handler handler)
+        : stream_(std::move(stream)), group_(std::move(group)), consumer_(consumerName()), handler_(std::move(handler)) {}
+
+    EventStream(const EventStream &) = delete;
+    EventStream &operator=(const EventStream &) = delete;
+
+    ~EventStream()
+    {
+      stop();
+    }
+
+    void start()
+    {
+      if (!running_.load())
+      {
+        running_.store(true);
+        worker_ = std::thread(&EventStream::run, this);
+      }
+    }
+
+    // Returns within one BLOCK interval; a batch being handled is finished first
+    void stop()
+    {
+      running_.store(false);
+      if (worker_.joinable())
+      {
+        worker_.join();
+      }
+    }
+
+    bool isRunning() const { return running_.load(); }
+
+    nlohmann::json stats() const
+    {
+      return {{"stream", stream_},
+              {"consumer", consumer_},
+              {"handled", handled_.load()},
+              {"acked", acked_.load()},
+              {"reclaimed", reclaimed_.load()},
+              {"dead", dead_.load()},
+              {"handler_errors", errors_.load()}};
+    }
+
+  private:
+    using Attrs = std::vector<std::pair<std::string, std::string>>;
+    using Item = std::pair<std::string, std::optional<Attrs>>;
+    using ItemStream = std::vector<Item>;
+    // id, consumer, idle ms, delivery count
+    using PendingEntry = std::tuple<std::string, std::string, long long, long long>;
+
+    static constexpr auto BLOCK = std::chrono::milliseconds(1000);
+    // Entries delivered this often without an XACK are acknowledged and dropped
+    static constexpr long long MAX_DELIVERIES = 5;
+    static constexpr int MAX_RECONNECT_DELAY_MS = 30000;
+    static constexpr int INITIAL_RECONNECT_DELAY_MS = 1000;
+
+    std::string stream_;
+    std::string group_;
+    std::string consumer_;
+    Handler handler_;
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+
+    std::atomic<uint64_t> handled_{0};
+    std::atomic<uint64_t> acked_{0};
+    std::atomic<uint64_t> reclaimed_{0};
+    std::atomic<uint64_t> dead_{0};
+    std::atomic<uint64_t> errors_{0};
+
+    // Stable across reconnects, so this process's own pending entries come back to it
+    static std::string consumerName()
+    {
+      char host[256] = {};
+      gethostname(host, sizeof(host) - 1);
+      return std::string(host) + ":" + std::to_string(getpid());
+    }
+
+    void run()
+    {
+      int reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
+      auto reclaimIdle = std::chrono::milliseconds(Config::AppConfig::getEventStreamReclaimIdleMs());
+
+      while (running_.load())
+      {
+        try
+        {
+          // A connection of its own: XREADGROUP blocks longer than the pooled socket timeout
+          auto options = RedisManager::connectionOptions();
+          options.socket_timeout += BLOCK;
+          sw::redis::Redis redis(options);
+          createGroup(redis);
+
+          // Entries this consumer read but did not acknowledge before a reconnect
+          read(redis, "0");
+          reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
+
+          auto nextReclaim = std::chrono::steady_clock::now();
+          while (running_.load())
+          {
+            if (std::chrono::steady_clock::now() >= nextReclaim)
+            {
+              reclaim(redis, reclaimIdle);
+              nextReclaim = std::chrono::steady_clock::now() + reclaimIdle / 2;
+            }
+            read(redis, ">");
+          }
+        }
+        catch (const sw::redis::Error &e)
+        {
+          if (running_.load())
+          {
+            std::cerr << "[Events] Redis error on stream '" << stream_ << "': " << e.what()
+                      << ". Reconnecting in " << reconnectDelay << "ms..." << std::endl;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(reconnectDelay));
+
+            // Exponential backoff with max limit
+            reconnectDelay = std::min(reconnectDelay * 2, MAX_RECONNECT_DELAY_MS);
+          }
+        }
+      }
+    }
+
+    void createGroup(sw::redis::Redis &redis)
+    {
+      try
+      {
+        redis.xgroup_create(stream_, group_, "$", true);
+      }
+      catch (const sw::redis::ReplyError &e)
+      {
+        // Another node, or an earlier run, created it
+        if (std::string(e.what()).rfind("BUSYGROUP", 0) != 0)
+        {
+          throw;
+        }
+      }
+    }
+
+    // One XREADGROUP of up to EVENT_STREAM_BATCH entries, one XACK for them
+    void read(sw::redis::Redis &redis, const std::string &id)
+    {
+      std::unordered_map<std::string, ItemStream> result;
+      redis.xreadgroup(group_, consumer_, stream_, id, Config::AppConfig::getEventStreamBatch(), BLOCK, false,
+                       std::inserter(result, result.end()));
+
+      auto it = result.find(stream_);
+      if (it != result.end())
+      {
+        handle(redis, it->second);
+      }
+    }
+
+    // Claim entries other consumers have held for longer than idle
+    void reclaim(sw::redis::Redis &redis, std::chrono::milliseconds idle)
+    {
+      std::vector<PendingEntry> pending;
+      redis.xpending(stream_, group_, "-", "+", Config::AppConfig::getEventStreamBatch(), std::back_inserter(pending));
+
+      std::vector<std::string> claim;
+      std::vector<std::string> dead;
+      for (const auto &[id, consumer, idleMs, deliveries] : pending)
+      {
+        if (idleMs < idle.count())
+        {
+          continue;
+        }
+        (deliveries >= MAX_DELIVERIES ? dead : claim).push_back(id);
+      }
+
+      if (!dead.empty())
+      {
+        // Poison entries: their handler keeps failing or killing the consumer
+        redis.xack(stream_, group_, dead.begin(), dead.end());
+        dead_ += dead.size();
+        std::cerr << "[Events] Dropped " << dead.size() << " entries from stream '" << stream_
+                  << "' after " << MAX_DELIVERIES << " deliveries" << std::endl;
+      }
+      if (claim.empty())
+      {
+        return;
+      }
+
+      ItemStream items;
+      redis.xclaim(stream_, group_, consumer_, idle, claim.begin(), claim.end(), std::back_inserter(items));
+      reclaimed_ += items.size();
+      handle(redis, items);
+    }
+
+    // Handle in stream order, then acknowledge the batch in one XACK. Entries
+    // whose handler throws stay pending and are retried by reclaim().
+    void handle(sw::redis::Redis &redis, const ItemStream &items)
+    {
+      std::vector<std::string> done;
+      done.reserve(items.size());
+      for (const auto &[id, attrs] : items)
+      {
+        // Trimmed by MAXLEN while pending: nothing left to handle
+        if (!attrs)
+        {
+          done.push_back(id);
+          continue;
+        }
+
+        auto field = std::find_if(attrs->begin(), attrs->end(), [](const auto &attr)
+                                  { return attr.first == FIELD; });
+        try
+        {
+          if (field != attrs->end())
+          {
+            handler_(stream_, field->second);
+          }
+          handled_++;
+          done.push_back(id);
+        }
+        catch (const std::exception &e)
+        {
+          errors_++;
+          std::cerr << "[Events] Handler failed on stream '" << stream_ << "' entry " << id << ": " << e.what() << std::endl;
+        }
+      }
+
+      if (!done.empty())
+      {
+        redis.xack(stream_, group_, done.begin(), done.end());
+        acked_ += done.size();
+      }
+    }
+  };
+}
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <zlib.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../config/config.hpp"
+
+namespace Events
+{
+  // Asynchronous line sink. Producers push into a bounded lock-free ring and
+  // return at once; one writer thread drains it and writes whole batches with
+  // a single call, flushing once per batch instead of once per line. When the
+  // ring is full the line is dropped and counted, never blocking a producer.
+  //
+  // With a path, output goes to that file, rotated to path.1 .. path.<files-1>
+  // once it passes maxBytes. When compressLevel > 0 a second thread gzips each
+  // rotated file, so the writer never waits on zlib; a file that failed to
+  // compress is kept and shifted as it is. Without a path output goes to stdout.
+  class LogSink
+  {
+  public:
+    struct Options
+    {
+      std::string path;
+      size_t queueSize = 65536;
+      size_t maxBytes = 64 * 1024 * 1024;
+      size_t maxFiles = 5;
+      int compressLevel = 0;
+
+      static Options fromConfig()
+      {
+        Options options;
+        if (const char *path = Config::AppConfig::getLogFile())
+        {
+          options.path = path;
+        }
+        options.queueSize = static_cast<size_t>(Config::AppConfig::getLogQueueSize());
+        options.maxBytes = static_cast<size_t>(Config::AppConfig::getLogMaxBytes());
+        options.maxFiles = static_cast<size_t>(Config::AppConfig::getLogMaxFiles());
+        options.compressLevel = Config::AppConfig::getLogCompressLevel();
+        return options;
+      }
+    };
+
+    explicit LogSink(Options options)
+        : options_(std::move(options)), capacity_(roundUp(options_.queueSize)), slots_(new Slot[capacity_])
+    {
+      for (size_t i = 0; i < capacity_; ++i)
+      {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+      writer_ = std::thread(&LogSink::run, this);
+      if (!options_.path.empty() && options_.compressLevel > 0)
+      {
+        compressor_ = std::thread(&LogSink::compressRotated, this);
+      }
+    }
+
+    LogSink(const LogSink &) = delete;
+    LogSink &operator=(const LogSink &) = delete;
+
+    // Writes out everything already pushed before returning
+    ~LogSink()
+    {
+      {
+        std::lock_guard<std::mutex> lock(wakeMtx_);
+        stopping_ = true;
+      }
+      wake_.notify_one();
+      writer_.join();
+
+      if (compressor_.joinable())
+      {
+        {
+          std::lock_guard<std::mutex> lock(filesMtx_);
+          compressorStopping_ = true;
+        }
+        compressWake_.notify_one();
+        compressor_.join();
+      }
+    }
+
+    // Safe from any thread; false if the line was dropped
+    bool push(std::string line)
+    {
+      size_t position = tail_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        auto &slot = slots_[position & (capacity_ - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (diff == 0)
+        {
+          if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            slot.line = std::move(line);
+            slot.sequence.store(position + 1, std::memory_order_release);
+            pushed_.fetch_add(1, std::memory_order_relaxed);
+            wakeWriter();
+            return true;
+          }
+        }
+        else if (diff < 0)
+        {
+          // The writer has not freed this slot yet: the ring is full
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        else
+        {
+          position = tail_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    nlohmann::json stats() const
+    {
+      return {{"pushed", pushed_.load()},
+              {"written", written_.load()},
+              {"dropped", dropped_.load()},
+              {"batches", batches_.load()},
+              {"rotations", rotations_.load()},
+              {"write_errors", writeErrors_.load()}};
+    }
+
+  private:
+    struct Slot
+    {
+      // position when free, position + 1 once a line is stored
+      std::atomic<size_t> sequence;
+      std::string line;
+    };
+
+    // Producers wake an idle writer; this only bounds how long it sleeps
+    static constexpr auto IDLE_WAIT = std::chrono::milliseconds(20);
+    static constexpr size_t MAX_BATCH_BYTES = 256 * 1024;
+
+    Options options_;
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    // Producers claim positions at tail_; only the writer advances head_
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) size_t head_ = 0;
+
+    std::thread writer_;
+    std::mutex wakeMtx_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::atomic<bool> sleeping_{false};
+
+    std::FILE *file_ = nullptr;
+    size_t fileBytes_ = 0;
+
+    // Held for renames only, never while compressing
+    std::mutex filesMtx_;
+    // Rotations so far; a rotation's file is at path.<rotations_ - number + 1>
+    uint64_t rotationCount_ = 0;
+    std::thread compressor_;
+    std::condition_variable compressWake_;
+    std::deque<uint64_t> compressQueue_;
+    bool compressorStopping_ = false;
+
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> rotations_{0};
+    std::atomic<uint64_t> writeErrors_{0};
+
+    static size_t roundUp(size_t n)
+    {
+      size_t capacity = 2;
+      while (capacity < n)
+      {
+        capacity <<= 1;
+      }
+      return capacity;
+    }
+
+    // Pairs with the writer's check in run(): either it sees the new line or
+    // this sees it asleep. Only the first producer after it sleeps locks.
+    void wakeWriter()
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false))
+      {
+        std::lock_guard<std::mutex> lock(wakeMtx_);
+        wake_.notify_one();
+      }
+    }
+
+    bool readable() const
+    {
+      return slots_[head_ & (capacity_ - 1)].sequence.load(std::memory_order_acquire) == head_ + 1;
+    }
+
+    bool pop(std::string &line)
+    {
+      if (!readable())
+      {
+        return false;
+      }
+      auto &slot = slots_[head_ & (capacity_ - 1)];
+      line = std::move(slot.line);
+      slot.line.clear();
+      slot.sequence.store(head_ + capacity_, std::memory_order_release);
+      ++head_;
+      return true;
+    }
+
+    void run()
+    {
+      open();
+      std::string batch;
+      std::string line;
+      uint64_t droppedReported = 0;
+
+      for (;;)
+      {
+        size_t lines = 0;
+        while (batch.size() < MAX_BATCH_BYTES && pop(line))
+        {
+          batch += line;
+          batch += '\n';
+          ++lines;
+        }
+
+        // Drops are reported in the log itself, where the gap shows up
+        auto dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != droppedReported)
+        {
+          batch += "[LogSink] dropped " + std::to_string(dropped - droppedReported) + " lines, queue full\n";
+          droppedReported = dropped;
+        }
+
+        if (!batch.empty())
+        {
+          write(batch);
+          written_.fetch_add(lines, std::memory_order_relaxed);
+          batches_.fetch_add(1, std::memory_order_relaxed);
+          batch.clear();
+          continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMtx_);
+        if (stopping_)
+        {
+          break;
+        }
+        sleeping_.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!readable())
+        {
+          wake_.wait_for(lock, IDLE_WAIT);
+        }
+        sleeping_.store(false);
+      }
+
+      if (file_ && file_ != stdout)
+      {
+        std::fclose(file_);
+      }
+    }
+
+    void open()
+    {
+      if (options_.path.empty())
+      {
+        file_ = stdout;
+        return;
+      }
+      file_ = std::fopen(options_.path.c_str(), "ab");
+      if (!file_)
+      {
+        std::cerr << "[LogSink] Cannot open " << options_.path << ", logging to stdout" << std::endl;
+        file_ = stdout;
+        return;
+      }
+      std::error_code ec;
+      auto size = std::filesystem::file_size(options_.path, ec);
+      fileBytes_ = ec ? 0 : static_cast<size_t>(size);
+    }
+
+    void write(const std::string &batch)
+    {
+      if (std::fwrite(batch.data(), 1, batch.size(), file_) != batch.size() || std::fflush(file_) != 0)
+      {
+        writeErrors_.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (file_ == stdout)
+      {
+        return;
+      }
+      fileBytes_ += batch.size();
+      if (fileBytes_ >= options_.maxBytes)
+      {
+        rotate();
+      }
+    }
+
+    // path -> path.1 -> ... -> path.<maxFiles - 1>; the oldest is deleted
+    void rotate()
+    {
+      std::fclose(file_);
+      file_ = nullptr;
+
+      bool queued = false;
+      {
+        std::lock_guard<std::mutex> lock(filesMtx_);
+        std::error_code ec;
+        if (options_.maxFiles > 1)
+        {
+          // Plain files too: one may be waiting for, or have failed, compression
+          for (const char *suffix : {"", ".gz"})
+          {
+            std::filesystem::remove(rotated(options_.maxFiles - 1) + suffix, ec);
+            for (size_t i = options_.maxFiles - 1; i > 1; --i)
+            {
+              std::filesystem::rename(rotated(i - 1) + suffix, rotated(i) + suffix, ec);
+            }
+          }
+          std::filesystem::rename(options_.path, rotated(1), ec);
+        }
+        else
+        {
+          std::filesystem::remove(options_.path, ec);
+        }
+
+        ++rotationCount_;
+        if (!ec && options_.maxFiles > 1 && compressor_.joinable())
+        {
+          compressQueue_.push_back(rotationCount_);
+          queued = true;
+        }
+      }
+      if (queued)
+      {
+        compressWake_.notify_one();
+      }
+
+      rotations_.fetch_add(1, std::memory_order_relaxed);
+      fileBytes_ = 0;
+      open();
+    }
+
+    std::string rotated(size_t index) const
+    {
+      return options_.path + "." + std::to_string(index);
+    }
+
+    // Where the file of rotation number is now, or 0 once it has been
+    // deleted; needs filesMtx_
+    size_t indexOf(uint64_t number) const
+    {
+      auto index = rotationCount_ - number + 1;
+      return index < options_.maxFiles ? static_cast<size_t>(index) : 0;
+    }
+
+    // Compressor thread: gzips rotated files into a temporary file without
+    // holding filesMtx_, then renames it to wherever the file has moved
+    void compressRotated()
+    {
+      std::string temporary = options_.path + ".gz.tmp";
+      for (;;)
+      {
+        uint64_t number;
+        std::FILE *in = nullptr;
+        {
+          std::unique_lock<std::mutex> lock(filesMtx_);
+          compressWake_.wait(lock, [this]
+                             { return compressorStopping_ || !compressQueue_.empty(); });
+          // Files rotated before shutdown are still compressed
+          if (compressQueue_.empty())
+          {
+            return;
+          }
+          number = compressQueue_.front();
+          compressQueue_.pop_front();
+          if (size_t index = indexOf(number))
+          {
+            in = std::fopen(rotated(index).c_str(), "rb");
+          }
+        }
+        if (!in)
+        {
+          continue;
+        }
+
+        bool ok = compress(in, temporary);
+
+        std::lock_guard<std::mutex> lock(filesMtx_);
+        std::error_code ec;
+        size_t index = indexOf(number);
+        if (ok && index)
+        {
+          std::filesystem::rename(temporary, rotated(index) + ".gz", ec);
+          if (!ec)
+          {
+            std::filesystem::remove(rotated(index), ec);
+          }
+        }
+        if (!ok || !index || ec)
+        {
+          std::filesystem::remove(temporary, ec);
+        }
+        if (!ok)
+        {
+          writeErrors_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // Writes in to path as gzip and closes in; false on any error
+    bool compress(std::FILE *in, const std::string &path)
+    {
+      std::string mode = "wb" + std::to_string(options_.compressLevel);
+      gzFile out = gzopen(path.c_str(), mode.c_str());
+      bool ok = out != nullptr;
+
+      std::vector<char> buffer(64 * 1024);
+      size_t read = 0;
+      while (ok && (read = std::fread(buffer.data(), 1, buffer.size(), in)) > 0)
+      {
+        ok = gzwrite(out, buffer.data(), static_cast<unsigned>(read)) == static_cast<int>(read);
+      }
+      ok = ok && !std::ferror(in);
+      std::fclose(in);
+      if (out && gzclose(out) != Z_OK)
+      {
+        ok = false;
+      }
+      return ok;
+    }
+  };
+}
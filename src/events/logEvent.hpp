@@ -1,92 +1,24 @@
 #pragma once
 
-#include <iostream>
-#include <thread>
-#include <atomic>
-#include <chrono>
-#include "../redis/RedisManager.hpp"
+#include <string>
+#include "LogSink.hpp"
 
-class LogEventSubscriber
+// Handler for log events, from the Redis "log" channel or the durable
+// STREAM. Lines go to a LogSink, so a burst of messages never waits on the
+// disk or the terminal.
+class LogEventHandler
 {
-private:
-  std::atomic<bool> running_{false};
-  std::thread worker_;
-  static constexpr int MAX_RECONNECT_DELAY_MS = 30000;
-  static constexpr int INITIAL_RECONNECT_DELAY_MS = 1000;
-
-  void run()
-  {
-    int reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
-
-    while (running_.load())
-    {
-      try
-      {
-        RedisManager manager;
-        auto *redis = manager.getRedis();
-        auto sub = redis->subscriber();
-
-        sub.subscribe("log");
-
-        sub.on_message([](std::string channel, std::string msg)
-                       { std::cout << "[Redis] " << channel << ": " << msg << std::endl; });
-
-        // Reset delay on successful connection
-        reconnectDelay = INITIAL_RECONNECT_DELAY_MS;
-        std::cout << "[LogEvent] Subscribed to 'log' channel" << std::endl;
-
-        // Use consume with timeout to allow checking running_ flag
-        while (running_.load())
-        {
-          try
-          {
-            sub.consume();
-          }
-          catch (const sw::redis::TimeoutError &)
-          {
-            // Timeout is expected, continue loop to check running_ flag
-          }
-        }
-      }
-      catch (const sw::redis::Error &e)
-      {
-        if (running_.load())
-        {
-          std::cerr << "[LogEvent] Redis error: " << e.what()
-                    << ". Reconnecting in " << reconnectDelay << "ms..." << std::endl;
-
-          std::this_thread::sleep_for(std::chrono::milliseconds(reconnectDelay));
-
-          // Exponential backoff with max limit
-          reconnectDelay = std::min(reconnectDelay * 2, MAX_RECONNECT_DELAY_MS);
-        }
-      }
-    }
-  }
-
 public:
-  void start()
-  {
-    if (!running_.load())
-    {
-      running_.store(true);
-      worker_ = std::thread(&LogEventSubscriber::run, this);
-    }
-  }
+  static constexpr const char *CHANNEL = "log";
+  static constexpr const char *STREAM = "events:log";
 
-  void stop()
-  {
-    running_.store(false);
-    if (worker_.joinable())
-    {
-      worker_.join();
-    }
-  }
-
-  bool isRunning() const { return running_.load(); }
+  LogEventHandler() : sink_(Events::LogSink::Options::fromConfig()) {}
 
-  ~LogEventSubscriber()
+  void operator()(const std::string &channel, const std::string &msg)
   {
-    stop();
+    sink_.push("[Redis] " + channel + ": " + msg);
   }
-};
\ No newline at end of file
+
+private:
+  Events::LogSink sink_;
+};
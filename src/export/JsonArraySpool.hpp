@@ -0,0 +1,188 @@
+#pragma once
+#include "crow.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Export
+{
+  using json = nlohmann::json;
+
+  // Owns the descriptor Crow reads a finished spool through. Crow opens the
+  // file only after the handler has returned, so this must outlive the
+  // response; SpoolMiddleware keeps it in the request context.
+  class SpoolFile
+  {
+  public:
+    SpoolFile() = default;
+    SpoolFile(const SpoolFile &) = delete;
+    SpoolFile &operator=(const SpoolFile &) = delete;
+
+    SpoolFile(SpoolFile &&other) noexcept : fd_(other.fd_)
+    {
+      other.fd_ = -1;
+    }
+
+    SpoolFile &operator=(SpoolFile &&other) noexcept
+    {
+      if (this != &other)
+      {
+        reset(other.fd_);
+        other.fd_ = -1;
+      }
+      return *this;
+    }
+
+    ~SpoolFile()
+    {
+      reset();
+    }
+
+    // Closing the last descriptor frees the disk space of the unlinked file
+    void reset(int fd = -1)
+    {
+      if (fd_ >= 0)
+      {
+        ::close(fd_);
+      }
+      fd_ = fd;
+    }
+
+  private:
+    int fd_ = -1;
+  };
+
+  // Writes a JSON array element by element to a temporary file through a
+  // fixed-size buffer, then hands the file to Crow, which sends it in chunks.
+  // Memory use stays at the buffer size no matter how many elements are written.
+  //
+  // The file is created 0600 in a directory only this user can enter and is
+  // unlinked as soon as it is created, so no other process can open it and a
+  // crash leaves nothing behind. Crow reads it through /proc/self/fd.
+  class JsonArraySpool
+  {
+  public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    JsonArraySpool()
+    {
+      auto dir = spoolDirectory();
+      static std::atomic<uint64_t> counter{0};
+      auto path = (dir / ("spool_" + std::to_string(::getpid()) + "_" + std::to_string(++counter) + ".json")).string();
+
+      int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+      if (fd < 0)
+      {
+        throw std::runtime_error("Could not open spool file");
+      }
+      ::unlink(path.c_str());
+
+      file_ = ::fdopen(fd, "w+b");
+      if (!file_)
+      {
+        ::close(fd);
+        throw std::runtime_error("Could not open spool file");
+      }
+
+      buffer_.reserve(BUFFER_SIZE + 1024);
+      buffer_.push_back('[');
+    }
+
+    JsonArraySpool(const JsonArraySpool &) = delete;
+    JsonArraySpool &operator=(const JsonArraySpool &) = delete;
+
+    ~JsonArraySpool()
+    {
+      if (file_)
+      {
+        std::fclose(file_);
+      }
+    }
+
+    void push(const json &element)
+    {
+      if (count_++ > 0)
+      {
+        buffer_.push_back(',');
+      }
+      buffer_ += element.dump();
+
+      if (buffer_.size() >= BUFFER_SIZE)
+      {
+        flush();
+      }
+    }
+
+    size_t count() const
+    {
+      return count_;
+    }
+
+    // Close the array and turn the spool file into the response body; owner
+    // keeps the file open until Crow has sent it
+    crow::response finish(SpoolFile &owner)
+    {
+      buffer_.push_back(']');
+      flush();
+      if (std::fflush(file_) != 0)
+      {
+        throw std::runtime_error("Could not write spool file");
+      }
+
+      // Keep only the descriptor; the FILE buffer is already empty
+      int fd = ::dup(::fileno(file_));
+      std::fclose(file_);
+      file_ = nullptr;
+      if (fd < 0)
+      {
+        throw std::runtime_error("Could not write spool file");
+      }
+      owner.reset(fd);
+
+      crow::response res;
+      res.set_static_file_info_unsafe("/proc/self/fd/" + std::to_string(fd));
+      // The path has no extension to take the Content-Type from
+      res.set_header("Content-Type", "application/json");
+      return res;
+    }
+
+  private:
+    std::FILE *file_ = nullptr;
+    std::string buffer_;
+    size_t count_ = 0;
+
+    void flush()
+    {
+      if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size())
+      {
+        throw std::runtime_error("Could not write spool file");
+      }
+      buffer_.clear();
+    }
+
+    // <tmp>/cpp_api_spool_<uid>, mode 0700; refuses one another user planted
+    static std::filesystem::path spoolDirectory()
+    {
+      auto dir = std::filesystem::temp_directory_path() / ("cpp_api_spool_" + std::to_string(::geteuid()));
+      if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+      {
+        throw std::runtime_error("Could not create spool directory");
+      }
+
+      struct stat info;
+      if (::lstat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != ::geteuid() ||
+          (info.st_mode & 0077) != 0)
+      {
+        throw std::runtime_error("Spool directory is not private");
+      }
+      return dir;
+    }
+  };
+}
@@ -1,10 +1,30 @@
 #include "routes/RouteManager.hpp"
+#include "config/ReloadSignal.hpp"
 #include "database/MigrationManager.hpp"
+#include "database/ConnectionPool.hpp"
+#include "database/DatabaseExecutor.hpp"
+#include "utils/PasswordHasher.hpp"
+#include "auth/KeyStore.hpp"
+#include "auth/RevocationList.hpp"
 #include "middlewares/JWTMiddleware.hpp"
 #include "events/EventManager.hpp"
 
 int main(int argc, char *argv[])
 {
+  // Before any thread exists, so SIGHUP only ever reaches the reload thread
+  Config::ReloadSignal::block();
+
+  try
+  {
+    Config::AppConfig::load();
+    Auth::KeyStore::load();
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << "Invalid configuration: " << e.what() << std::endl;
+    return 1;
+  }
+
   if (argc > 1 && strcmp(argv[1], "-migrate") == 0)
   {
     MigrationManager manager;
@@ -14,6 +34,28 @@ int main(int argc, char *argv[])
 
   auto &app = Router::getApp();
 
+  // Open the shared MySQL connection pool before accepting requests
+  ConnectionPool::init(PoolOptions::fromConfig());
+  DatabaseExecutor::init(Config::AppConfig::getDBExecutorThreads(), Config::AppConfig::getDBExecutorQueueSize());
+  PasswordHasher::init(Config::AppConfig::getPasswordHashThreads(), Config::AppConfig::getPasswordHashQueueSize());
+  // Revoked tokens must be known before the first request; the subscriber
+  // reloads the list whenever it reconnects
+  Auth::RevocationList::load();
+
+  // Pool sizes and JWT keys follow config reloads; the KDF cost is read per
+  // use, so only the login dummy hash is rebuilt, and TokenCache flushes
+  // itself when the keys change
+  Config::AppConfig::onReload([](const Config::Settings &, const Config::Settings &current)
+                              {
+    Auth::KeyStore::reload();
+    ConnectionPool::reconfigure(PoolOptions::fromConfig());
+    DatabaseExecutor::resize(current.dbExecutorThreads, current.dbExecutorQueueSize);
+    PasswordHasher::resize(current.passwordHashThreads, current.passwordHashQueueSize);
+    PasswordHasher::refreshDummyHash(); });
+
+  Config::ReloadSignal reloadSignal;
+  reloadSignal.start();
+
   // Start event subscribers
   Events::EventManager eventManager;
   eventManager.start();
@@ -26,5 +68,10 @@ int main(int argc, char *argv[])
       .multithreaded()
       .run();
 
+  reloadSignal.stop();
+  DatabaseExecutor::shutdown();
+  PasswordHasher::shutdown();
+  ConnectionPool::shutdown();
+
   return 0;
 }
\ No newline at end of file
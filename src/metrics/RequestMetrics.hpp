@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Metrics
+{
+  // Per-route, per-method, per-status request latency and byte counts,
+  // exported in the Prometheus text format.
+  //
+  // Every recording thread owns a shard it alone writes, with plain relaxed
+  // loads and stores instead of locked read-modify-writes, so recording costs
+  // a hash lookup and a few uncontended stores. A scrape merges the shards.
+  class RequestMetrics
+  {
+  public:
+    // Bucket i counts latencies of at most 2^i microseconds; the last is unbounded
+    static constexpr size_t BUCKETS = 28;
+    // Exported le bounds start at 2^6us = 64us; faster requests fold into it
+    static constexpr size_t FIRST_EXPORTED_BUCKET = 6;
+    // Beyond this many series across all threads, new routes are recorded as
+    // "other"; a route seen on several threads counts once per thread.
+    // "other" and "unmatched" series are not counted
+    static constexpr size_t MAX_SERIES = 4096;
+    // Route label of requests no rule matched
+    static constexpr const char *UNMATCHED = "unmatched";
+    // Route label of requests past MAX_SERIES or that no handler labelled
+    static constexpr const char *OTHER = "other";
+
+    // route is the matched rule template, never the request path, so the
+    // number of series stays bounded by the number of rules
+    static void record(std::string_view method, std::string_view route, int status,
+                       std::chrono::microseconds elapsed, size_t requestBytes, size_t responseBytes)
+    {
+      auto &shard = localShard();
+      Key key{std::string(route), std::string(method), status};
+
+      auto it = shard.series.find(key);
+      if (it == shard.series.end() && key.route != UNMATCHED && key.route != OTHER && !reserveSeries())
+      {
+        key.route = OTHER;
+        it = shard.series.find(key);
+      }
+      if (it == shard.series.end())
+      {
+        // Only this thread inserts; the lock keeps a concurrent scrape's iteration valid
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        it = shard.series.try_emplace(std::move(key)).first;
+      }
+
+      auto &series = it->second;
+      auto micros = static_cast<uint64_t>(std::max<int64_t>(0, elapsed.count()));
+      bump(series.buckets[bucketFor(micros)], 1);
+      bump(series.count, 1);
+      bump(series.sumMicros, micros);
+      bump(series.requestBytes, requestBytes);
+      bump(series.responseBytes, responseBytes);
+    }
+
+    static std::string prometheus()
+    {
+      auto merged = snapshot();
+      std::string out;
+      out.reserve(merged.size() * 2048);
+
+      out += "# HELP http_request_duration_seconds Request latency by route, method and status.\n"
+             "# TYPE http_request_duration_seconds histogram\n";
+      for (const auto &[key, totals] : merged)
+      {
+        auto labels = labelsFor(key);
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < BUCKETS - 1; ++i)
+        {
+          cumulative += totals.buckets[i];
+          if (i >= FIRST_EXPORTED_BUCKET)
+          {
+            out += "http_request_duration_seconds_bucket{" + labels + ",le=\"" + seconds(uint64_t(1) << i, "%g") + "\"} " +
+                   std::to_string(cumulative) + "\n";
+          }
+        }
+        out += "http_request_duration_seconds_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(totals.count) + "\n";
+        out += "http_request_duration_seconds_sum{" + labels + "} " + seconds(totals.sumMicros, "%.6f") + "\n";
+        out += "http_request_duration_seconds_count{" + labels + "} " + std::to_string(totals.count) + "\n";
+      }
+
+      out += "# HELP http_request_size_bytes_total Request body bytes received.\n"
+             "# TYPE http_request_size_bytes_total counter\n";
+      for (const auto &[key, totals] : merged)
+      {
+        out += "http_request_size_bytes_total{" + labelsFor(key) + "} " + std::to_string(totals.requestBytes) + "\n";
+      }
+
+      out += "# HELP http_response_size_bytes_total Response body bytes sent.\n"
+             "# TYPE http_response_size_bytes_total counter\n";
+      for (const auto &[key, totals] : merged)
+      {
+        out += "http_response_size_bytes_total{" + labelsFor(key) + "} " + std::to_string(totals.responseBytes) + "\n";
+      }
+      return out;
+    }
+
+    static size_t bucketFor(uint64_t micros)
+    {
+      if (micros <= 1)
+      {
+        return 0;
+      }
+      // Bit length of micros - 1: the smallest i with micros <= 2^i
+      size_t bucket = 64 - static_cast<size_t>(__builtin_clzll(micros - 1));
+      return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+
+  private:
+    struct Key
+    {
+      std::string route;
+      std::string method;
+      int status;
+
+      bool operator==(const Key &other) const
+      {
+        return status == other.status && route == other.route && method == other.method;
+      }
+
+      bool operator<(const Key &other) const
+      {
+        return std::tie(route, method, status) < std::tie(other.route, other.method, other.status);
+      }
+    };
+
+    struct KeyHash
+    {
+      size_t operator()(const Key &key) const
+      {
+        size_t h = std::hash<std::string>{}(key.route);
+        h ^= std::hash<std::string>{}(key.method) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h ^ (static_cast<size_t>(key.status) * 0x9e3779b97f4a7c15ULL);
+      }
+    };
+
+    struct Series
+    {
+      std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+      std::atomic<uint64_t> count{0};
+      std::atomic<uint64_t> sumMicros{0};
+      std::atomic<uint64_t> requestBytes{0};
+      std::atomic<uint64_t> responseBytes{0};
+    };
+
+    struct Totals
+    {
+      std::array<uint64_t, BUCKETS> buckets{};
+      uint64_t count = 0;
+      uint64_t sumMicros = 0;
+      uint64_t requestBytes = 0;
+      uint64_t responseBytes = 0;
+    };
+
+    struct Shard
+    {
+      std::mutex mtx;
+      std::unordered_map<Key, Series, KeyHash> series;
+    };
+
+    std::mutex mtx_;
+    // Shards outlive their threads, so nothing recorded is lost
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> seriesCount_{0};
+
+    static RequestMetrics &instance()
+    {
+      static RequestMetrics instance;
+      return instance;
+    }
+
+    static Shard &localShard()
+    {
+      thread_local Shard *shard = []
+      {
+        auto &metrics = instance();
+        std::lock_guard<std::mutex> lock(metrics.mtx_);
+        metrics.shards_.push_back(std::make_unique<Shard>());
+        return metrics.shards_.back().get();
+      }();
+      return *shard;
+    }
+
+    // Single writer: a plain load and store, no lock prefix
+    static void bump(std::atomic<uint64_t> &counter, uint64_t amount)
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // Count a new series against MAX_SERIES; false once it is reached
+    static bool reserveSeries()
+    {
+      auto &count = instance().seriesCount_;
+      size_t current = count.load(std::memory_order_relaxed);
+      do
+      {
+        if (current >= MAX_SERIES)
+        {
+          return false;
+        }
+      } while (!count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+      return true;
+    }
+
+    static std::map<Key, Totals> snapshot()
+    {
+      auto &metrics = instance();
+      std::map<Key, Totals> merged;
+      std::lock_guard<std::mutex> lock(metrics.mtx_);
+      for (auto &shard : metrics.shards_)
+      {
+        std::lock_guard<std::mutex> shardLock(shard->mtx);
+        for (const auto &[key, series] : shard->series)
+        {
+          auto &totals = merged[key];
+          for (size_t i = 0; i < BUCKETS; ++i)
+          {
+            totals.buckets[i] += series.buckets[i].load(std::memory_order_relaxed);
+          }
+          totals.count += series.count.load(std::memory_order_relaxed);
+          totals.sumMicros += series.sumMicros.load(std::memory_order_relaxed);
+          totals.requestBytes += series.requestBytes.load(std::memory_order_relaxed);
+          totals.responseBytes += series.responseBytes.load(std::memory_order_relaxed);
+        }
+      }
+      return merged;
+    }
+
+    static std::string labelsFor(const Key &key)
+    {
+      return "route=\"" + escape(key.route) + "\",method=\"" + escape(key.method) +
+             "\",status=\"" + std::to_string(key.status) + "\"";
+    }
+
+    static std::string escape(const std::string &value)
+    {
+      std::string out;
+      out.reserve(value.size());
+      for (char c : value)
+      {
+        if (c == '\\' || c == '"')
+        {
+          out += '\\';
+          out += c;
+        }
+        else if (c == '\n')
+        {
+          out += "\\n";
+        }
+        else
+        {
+          out += c;
+        }
+      }
+      return out;
+    }
+
+    static std::string seconds(uint64_t micros, const char *format)
+    {
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), format, static_cast<double>(micros) / 1e6);
+      return buffer;
+    }
+  };
+}
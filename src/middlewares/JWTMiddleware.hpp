@@ -2,7 +2,11 @@
 #include "crow.h"
 #include "jwt-cpp/jwt.h"
 #include <string>
+#include "../auth/KeyStore.hpp"
+#include "../auth/RevocationList.hpp"
+#include "../cache/TokenCache.hpp"
 #include "../config/config.hpp"
+#include "../models/Identity.hpp"
 #include "../controllers/BaseController.hpp"
 
 namespace Middlewares
@@ -10,8 +14,12 @@ namespace Middlewares
   class JWTMiddleware : public crow::ILocalMiddleware, public Controllers::BaseController
   {
   public:
+    // Filled in before the handler runs; read it with app.get_context<JWTMiddleware>(req)
     struct context
     {
+      Identity identity;
+      // TokenCache::key of the presented token, e.g. to revoke it
+      std::string tokenKey;
     };
 
     void before_handle(crow::request &req, crow::response &res, context &ctx)
@@ -29,12 +37,46 @@ namespace Middlewares
 
         std::string token = auth_header.substr(7);
 
-        // Verify token
+        const auto &keys = Auth::KeyStore::current();
+        if (!keys.canVerify())
+        {
+          res = unauthorized("Invalid token");
+          res.end();
+          return;
+        }
+
+        // Checked first: for all but filter positives this is a local lookup
+        auto tokenKey = Cache::TokenCache::key(token);
+        if (Auth::RevocationList::isRevoked(tokenKey))
+        {
+          res = unauthorized("Token revoked");
+          res.end();
+          return;
+        }
+
+        // A token verified earlier is trusted until its exp claim passes
+        if (auto cached = Cache::TokenCache::get(tokenKey, keys.fingerprint()))
+        {
+          ctx.identity = std::move(*cached);
+          ctx.tokenKey = std::move(tokenKey);
+          return;
+        }
+
+        // Verify token with the prebuilt verifier for its kid
         auto decoded = jwt::decode(token);
-        auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::hs256(Config::AppConfig::getJWTSecret()));
+        const auto *verifier = keys.verifierFor(decoded.has_key_id() ? decoded.get_key_id() : "");
+        if (!verifier)
+        {
+          res = unauthorized("Invalid token");
+          res.end();
+          return;
+        }
 
-        verifier.verify(decoded);
+        verifier->verify(decoded);
+
+        ctx.identity = toIdentity(decoded);
+        Cache::TokenCache::put(tokenKey, keys.fingerprint(), ctx.identity);
+        ctx.tokenKey = std::move(tokenKey);
       }
       catch (const std::exception &e)
       {
@@ -47,5 +89,30 @@ namespace Middlewares
     {
       // Optional post-processing
     }
+
+  private:
+    // Throws for tokens without a numeric user_id, which handlers rely on
+    template <typename Decoded>
+    static Identity toIdentity(const Decoded &decoded)
+    {
+      Identity identity;
+      identity.userId = std::stoll(decoded.get_payload_claim("user_id").as_string());
+      if (decoded.has_payload_claim("email"))
+      {
+        identity.email = decoded.get_payload_claim("email").as_string();
+      }
+      if (decoded.has_payload_claim("sid"))
+      {
+        identity.sessionId = decoded.get_payload_claim("sid").as_string();
+      }
+      if (decoded.has_issued_at())
+      {
+        identity.issuedAt = decoded.get_issued_at();
+      }
+      // Tokens without exp are cached for JWT_CACHE_MAX_TTL_SECONDS at most
+      identity.expiresAt = decoded.has_expires_at() ? decoded.get_expires_at()
+                                                    : std::chrono::system_clock::time_point::max();
+      return identity;
+    }
   };
 }
@@ -0,0 +1,37 @@
+#pragma once
+#include "crow.h"
+#include <chrono>
+#include <string_view>
+#include "../metrics/RequestMetrics.hpp"
+
+namespace Middlewares
+{
+  // Global middleware: times every request and records it in RequestMetrics.
+  // Listed first in the App so the timing includes the other middlewares.
+  struct MetricsMiddleware
+  {
+    struct context
+    {
+      std::chrono::steady_clock::time_point start;
+      // Rule template set by the handler; requests rejected before their
+      // handler runs, such as by JWTMiddleware, are recorded as "other"
+      std::string_view route = Metrics::RequestMetrics::OTHER;
+    };
+
+    void before_handle(crow::request & /*req*/, crow::response & /*res*/, context &ctx)
+    {
+      ctx.start = std::chrono::steady_clock::now();
+    }
+
+    // Runs once the response is complete, including responses ended from
+    // DatabaseExecutor or PasswordHasher threads
+    void after_handle(crow::request &req, crow::response &res, context &ctx)
+    {
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - ctx.start);
+      // Static file responses leave body empty; Crow streams the file after this
+      size_t responseBytes = res.is_static_type() ? static_cast<size_t>(res.file_info.statbuf.st_size) : res.body.size();
+      Metrics::RequestMetrics::record(crow::method_name(req.method), ctx.route, res.code, elapsed,
+                                      req.body.size(), responseBytes);
+    }
+  };
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "crow.h"
+#include "../export/JsonArraySpool.hpp"
+
+namespace Middlewares
+{
+  // Global middleware: holds the descriptor of a spooled response body for
+  // as long as Crow keeps the request context. Crow sends a static file right
+  // after the handlers and replaces the context only when the connection
+  // reads its next request or closes, so the file is always open in time and
+  // closed as soon as it has been sent.
+  struct SpoolMiddleware
+  {
+    struct context
+    {
+      Export::SpoolFile file;
+    };
+
+    void before_handle(crow::request & /*req*/, crow::response & /*res*/, context & /*ctx*/) {}
+    void after_handle(crow::request & /*req*/, crow::response & /*res*/, context & /*ctx*/) {}
+  };
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// The caller behind a verified JWT, as decoded by JWTMiddleware
+struct Identity
+{
+  int64_t userId = 0;
+  std::string email;
+  // Refresh-token session the access token was minted for, if any
+  std::string sessionId;
+  std::chrono::system_clock::time_point issuedAt;
+  std::chrono::system_clock::time_point expiresAt;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "RedisManager.hpp"
+
+// Commands queued locally and sent together on flush(): one round trip for
+// the whole batch instead of one per command. Transaction mode wraps them in
+// MULTI/EXEC so other clients see all of them or none.
+//
+//   RedisBatch batch;
+//   batch.del(key).publish(channel, message);
+//   auto replies = batch.flush(); // replies.get<long long>(0) ...
+//
+// A pooled connection is held only while flush() runs.
+class RedisBatch
+{
+public:
+  enum class Mode
+  {
+    Pipeline,
+    Transaction
+  };
+
+  explicit RedisBatch(Mode mode = Mode::Pipeline) : mode_(mode) {}
+
+  // Any command, as its argument list, e.g. {"HSET", key, field, value}
+  RedisBatch &command(std::vector<std::string> args)
+  {
+    commands_.push_back(std::move(args));
+    return *this;
+  }
+
+  RedisBatch &set(const std::string &key, const std::string &value, std::chrono::milliseconds ttl)
+  {
+    return command({"SET", key, value, "PX", std::to_string(ttl.count())});
+  }
+
+  RedisBatch &del(const std::string &key)
+  {
+    return command({"DEL", key});
+  }
+
+  RedisBatch &publish(const std::string &channel, const std::string &message)
+  {
+    return command({"PUBLISH", channel, message});
+  }
+
+  size_t size() const
+  {
+    return commands_.size();
+  }
+
+  bool empty() const
+  {
+    return commands_.empty();
+  }
+
+  // Send every queued command and clear the queue; replies are in queue
+  // order. Throws sw::redis::Error, in which case nothing is retried.
+  sw::redis::QueuedReplies flush()
+  {
+    auto commands = std::move(commands_);
+    commands_.clear();
+
+    auto *redis = RedisManager().getRedis();
+    if (mode_ == Mode::Transaction)
+    {
+      // Piped: MULTI, the commands and EXEC go out in one write
+      auto tx = redis->transaction(true, false);
+      for (const auto &args : commands)
+      {
+        tx.command(args.begin(), args.end());
+      }
+      return tx.exec();
+    }
+
+    auto pipe = redis->pipeline(false);
+    for (const auto &args : commands)
+    {
+      pipe.command(args.begin(), args.end());
+    }
+    return pipe.exec();
+  }
+
+private:
+  Mode mode_;
+  std::vector<std::vector<std::string>> commands_;
+};
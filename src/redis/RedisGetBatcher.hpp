@@ -0,0 +1,145 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RedisManager.hpp"
+#include "../config/config.hpp"
+
+// GET with automatic batching: concurrent calls from different threads are
+// coalesced into one MGET.
+//
+// The first caller to find no open batch leads it. If no other batch is in
+// flight it sends right away, so an idle server pays no extra latency; under
+// load it first waits up to REDIS_GET_BATCH_WINDOW_US for followers, or until
+// REDIS_GET_BATCH_MAX keys have joined. Followers block until the leader
+// hands them their value. A window of 0 turns batching off.
+class RedisGetBatcher
+{
+public:
+  // Throws sw::redis::Error, to every caller in the failed batch
+  static sw::redis::OptionalString get(const std::string &key)
+  {
+    auto &batcher = instance();
+    auto window = std::chrono::microseconds(Config::AppConfig::getRedisGetBatchWindowUs());
+    if (window.count() == 0)
+    {
+      batcher.singles_++;
+      return RedisManager().getRedis()->get(key);
+    }
+
+    std::unique_lock<std::mutex> lock(batcher.mtx_);
+    auto batch = batcher.open_;
+    bool leader = !batch;
+    if (leader)
+    {
+      batch = batcher.open_ = std::make_shared<Batch>();
+    }
+    size_t slot = batch->keys.size();
+    batch->keys.push_back(key);
+
+    if (!leader)
+    {
+      if (batch->keys.size() >= static_cast<size_t>(Config::AppConfig::getRedisGetBatchMax()))
+      {
+        // Full: close it and wake the leader early
+        batcher.open_.reset();
+        batch->cv.notify_all();
+      }
+      batch->cv.wait(lock, [&batch]
+                     { return batch->done; });
+      if (batch->error)
+      {
+        std::rethrow_exception(batch->error);
+      }
+      return std::move(batch->values[slot]);
+    }
+
+    if (batcher.inFlight_ > 0)
+    {
+      batch->cv.wait_for(lock, window, [&]
+                         { return batcher.open_ != batch; });
+    }
+    if (batcher.open_ == batch)
+    {
+      batcher.open_.reset();
+    }
+    batcher.inFlight_++;
+    lock.unlock();
+
+    batcher.send(*batch);
+
+    lock.lock();
+    batcher.inFlight_--;
+    batch->done = true;
+    batch->cv.notify_all();
+    if (batch->error)
+    {
+      std::rethrow_exception(batch->error);
+    }
+    return std::move(batch->values[slot]);
+  }
+
+  static nlohmann::json stats()
+  {
+    auto &batcher = instance();
+    auto batches = batcher.batches_.load();
+    auto keys = batcher.batchedKeys_.load();
+    return {{"batches", batches},
+            {"batched_keys", keys},
+            {"average_batch", batches ? static_cast<double>(keys) / batches : 0.0},
+            {"unbatched", batcher.singles_.load()},
+            {"errors", batcher.errors_.load()}};
+  }
+
+private:
+  struct Batch
+  {
+    std::vector<std::string> keys;
+    std::vector<sw::redis::OptionalString> values;
+    std::exception_ptr error;
+    bool done = false;
+    std::condition_variable cv;
+  };
+
+  std::mutex mtx_;
+  // The batch new callers join; reset once its leader starts sending
+  std::shared_ptr<Batch> open_;
+  size_t inFlight_ = 0;
+
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> batchedKeys_{0};
+  std::atomic<uint64_t> singles_{0};
+  std::atomic<uint64_t> errors_{0};
+
+  static RedisGetBatcher &instance()
+  {
+    static RedisGetBatcher instance;
+    return instance;
+  }
+
+  // Runs without the lock; the batch is closed, so only the leader touches it
+  void send(Batch &batch)
+  {
+    try
+    {
+      batch.values.reserve(batch.keys.size());
+      RedisManager().getRedis()->mget(batch.keys.begin(), batch.keys.end(), std::back_inserter(batch.values));
+      batches_++;
+      batchedKeys_ += batch.keys.size();
+    }
+    catch (...)
+    {
+      errors_++;
+      batch.error = std::current_exception();
+    }
+  }
+};
@@ -3,40 +3,19 @@
 #include <sw/redis++/redis++.h>
 #include "../config/config.hpp"
 #include <iostream>
+#include <memory>
 #include <string>
 
 using namespace sw::redis;
 
+// Handle to the process-wide Redis client. Constructing one is free; every
+// handle shares one connection pool, so commands reuse warm connections
+// instead of connecting per request. The pool is sized from config on first
+// use; changing REDIS_* settings takes a restart.
 class RedisManager
 {
 public:
-  RedisManager()
-  {
-    try
-    {
-      // Create the connection URL using string concatenation
-      std::string connection_url = std::string("tcp://") +
-                                   Config::AppConfig::getRedisHost() + ":" +
-                                   std::to_string(Config::AppConfig::getRedisPort());
-
-      // Create connection options
-      ConnectionOptions connection_opts;
-      connection_opts.host = Config::AppConfig::getRedisHost();
-      connection_opts.port = Config::AppConfig::getRedisPort();
-
-      // Optional: Add timeout and other settings
-      connection_opts.socket_timeout = std::chrono::milliseconds(200);
-      connection_opts.connect_timeout = std::chrono::milliseconds(200);
-
-      // Initialize Redis connection with options
-      redis_ = std::make_unique<Redis>(connection_opts);
-    }
-    catch (const Error &e)
-    {
-      std::cerr << "Redis connection error: " << e.what() << std::endl;
-      throw;
-    }
-  }
+  RedisManager() = default;
 
   // Prevent copying
   RedisManager(const RedisManager &) = delete;
@@ -49,16 +28,56 @@ public:
   // Destructor
   ~RedisManager() = default;
 
-  // Getter for Redis connection
+  // Getter for the shared Redis client; throws sw::redis::Error if it cannot be created
   Redis *getRedis()
   {
-    if (!redis_)
+    return client();
+  }
+
+  // Options every connection uses, e.g. for a dedicated connection that
+  // blocks longer than the pooled socket timeout allows
+  static ConnectionOptions connectionOptions()
+  {
+    ConnectionOptions options;
+    options.host = Config::AppConfig::getRedisHost();
+    options.port = Config::AppConfig::getRedisPort();
+    options.socket_timeout = std::chrono::milliseconds(Config::AppConfig::getRedisTimeoutMs());
+    options.connect_timeout = std::chrono::milliseconds(Config::AppConfig::getRedisTimeoutMs());
+    // TCP keepalive notices peers that vanished without closing the socket
+    options.keep_alive = true;
+    return options;
+  }
+
+private:
+  static Redis *client()
+  {
+    // A failed construction is retried by the next call
+    static std::unique_ptr<Redis> redis = create();
+    return redis.get();
+  }
+
+  static std::unique_ptr<Redis> create()
+  {
+    try
     {
-      throw std::runtime_error("Redis connection not initialized");
+      return std::make_unique<Redis>(connectionOptions(), poolOptions());
+    }
+    catch (const Error &e)
+    {
+      std::cerr << "Redis connection error: " << e.what() << std::endl;
+      throw;
     }
-    return redis_.get();
   }
 
-private:
-  std::unique_ptr<Redis> redis_;
-};
\ No newline at end of file
+  static ConnectionPoolOptions poolOptions()
+  {
+    ConnectionPoolOptions options;
+    options.size = static_cast<size_t>(Config::AppConfig::getRedisPoolSize());
+    // How long a command waits for a free connection before failing
+    options.wait_timeout = std::chrono::milliseconds(Config::AppConfig::getRedisPoolWaitMs());
+    // Connections idle longer than this are reconnected before reuse, since
+    // the server or a NAT may have dropped them; 0 keeps them forever
+    options.connection_idle_time = std::chrono::milliseconds(Config::AppConfig::getRedisPoolIdleMs());
+    return options;
+  }
+};
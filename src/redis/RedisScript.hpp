@@ -0,0 +1,50 @@
+#pragma once
+
+#include <sw/redis++/redis++.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A Lua script run with EVALSHA, so only its digest crosses the wire. It is
+// loaded on first use and again whenever the server answers NOSCRIPT, e.g.
+// after a restart or SCRIPT FLUSH.
+class RedisScript
+{
+public:
+  explicit RedisScript(const char *source) : source_(source) {}
+
+  RedisScript(const RedisScript &) = delete;
+  RedisScript &operator=(const RedisScript &) = delete;
+
+  template <typename Result>
+  Result eval(sw::redis::Redis &redis, const std::vector<std::string> &keys, const std::vector<std::string> &args)
+  {
+    try
+    {
+      return redis.evalsha<Result>(sha(redis, false), keys.begin(), keys.end(), args.begin(), args.end());
+    }
+    catch (const sw::redis::ReplyError &e)
+    {
+      if (std::string(e.what()).rfind("NOSCRIPT", 0) != 0)
+      {
+        throw;
+      }
+      return redis.evalsha<Result>(sha(redis, true), keys.begin(), keys.end(), args.begin(), args.end());
+    }
+  }
+
+private:
+  const char *source_;
+  std::string sha_;
+  std::mutex mtx_;
+
+  std::string sha(sw::redis::Redis &redis, bool reload)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (sha_.empty() || reload)
+    {
+      sha_ = redis.script_load(source_);
+    }
+    return sha_;
+  }
+};
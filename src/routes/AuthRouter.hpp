@@ -10,11 +10,45 @@ namespace Routes
   class AuthRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       CROW_ROUTE(app, "/api/auth/login")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::AuthController::login(req); });
+          .methods("POST"_method)([&app](const crow::request &req, crow::response &res)
+                                  {
+            label(app, req, "/api/auth/login");
+            if (auto throttled = Controllers::AuthController::throttleLogin(req))
+            {
+              res = std::move(*throttled);
+              res.end();
+              return;
+            }
+            Controllers::AuthController::login(req, res); });
+
+      CROW_ROUTE(app, "/api/auth/refresh")
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/auth/refresh");
+            return Controllers::AuthController::refresh(req); });
+
+      CROW_ROUTE(app, "/api/auth/logout")
+          .CROW_MIDDLEWARES(app, Middlewares::JWTMiddleware)
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/auth/logout");
+            auto &ctx = app.get_context<Middlewares::JWTMiddleware>(req);
+            return Controllers::AuthController::logout(ctx.tokenKey, ctx.identity); });
+
+      CROW_ROUTE(app, "/.well-known/jwks.json")
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/.well-known/jwks.json");
+            return Controllers::AuthController::jwks(); });
+
+      CROW_ROUTE(app, "/api/auth/stats")
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/auth/stats");
+            return Controllers::AuthController::stats(); });
     }
   };
 }
\ No newline at end of file
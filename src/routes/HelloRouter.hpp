@@ -7,17 +7,23 @@ namespace Routes
   class HelloRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       CROW_ROUTE(app, "/api/hello")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::HelloController::hello(); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/hello");
+            return Controllers::HelloController::hello(); });
 
-      CROW_ROUTE(app, "/api/redis").methods("GET"_method)([](const crow::request &req)
-                                                          { return Controllers::HelloController::redis(); });
+      CROW_ROUTE(app, "/api/redis").methods("GET"_method)([&app](const crow::request &req)
+                                                          {
+            label(app, req, "/api/redis");
+            return Controllers::HelloController::redis(); });
 
-      CROW_ROUTE(app, "/api/sendMessage").methods("GET"_method)([](const crow::request &req)
-                                                                { return Controllers::HelloController::sendMessage(); });
+      CROW_ROUTE(app, "/api/sendMessage").methods("GET"_method)([&app](const crow::request &req)
+                                                                {
+            label(app, req, "/api/sendMessage");
+            return Controllers::HelloController::sendMessage(); });
     }
   };
 }
@@ -7,30 +7,38 @@ namespace Routes
   class I18nRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       // Initialize translations on router registration
       Controllers::I18nController::initializeTranslations();
 
       // Translate a key
       CROW_ROUTE(app, "/api/i18n/translate")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::I18nController::translate(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/i18n/translate");
+            return Controllers::I18nController::translate(req); });
 
       // Get available locales
       CROW_ROUTE(app, "/api/i18n/locales")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::I18nController::getLocales(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/i18n/locales");
+            return Controllers::I18nController::getLocales(req); });
 
       // Demo translations in all languages
       CROW_ROUTE(app, "/api/i18n/demo")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::I18nController::demo(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/i18n/demo");
+            return Controllers::I18nController::demo(req); });
 
       // Set locale
       CROW_ROUTE(app, "/api/i18n/locale")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::I18nController::setLocale(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/i18n/locale");
+            return Controllers::I18nController::setLocale(req); });
     }
   };
 }
@@ -0,0 +1,29 @@
+#pragma once
+#include "Router.hpp"
+#include "../controllers/MetricsController.hpp"
+
+namespace Routes
+{
+  class MetricsRouter : public Router
+  {
+  public:
+    void register_routes(App &app) override
+    {
+      CROW_ROUTE(app, "/metrics")
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/metrics");
+            return Controllers::MetricsController::metrics(); });
+
+      // Requests no rule matched; Crow has already set 404 or 405
+      CROW_CATCHALL_ROUTE(app)([&app](const crow::request &req, crow::response &res)
+                               {
+        label(app, req, Metrics::RequestMetrics::UNMATCHED);
+        if (res.code == 200)
+        {
+          res.code = 404;
+        }
+        res.end(); });
+    }
+  };
+}
@@ -11,6 +11,7 @@
 #include "FileRouter.hpp"
 #include "TestRouter.hpp"
 #include "WebSocketRouter.hpp"
+#include "MetricsRouter.hpp"
 #include <memory>
 #include <vector>
 
@@ -33,9 +34,10 @@ public:
     routers.push_back(std::make_unique<Routes::FileRouter>());
     routers.push_back(std::make_unique<Routes::TestRouter>());
     routers.push_back(std::make_unique<Routes::WebSocketRouter>());
+    routers.push_back(std::make_unique<Routes::MetricsRouter>());
   }
 
-  void register_all_routes(crow::App<Middlewares::JWTMiddleware> &app)
+  void register_all_routes(Router::App &app)
   {
     // Register all routes
     for (const auto &router : routers)
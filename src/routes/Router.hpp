@@ -2,16 +2,30 @@
 #pragma once
 #include "crow.h"
 #include "../middlewares/JWTMiddleware.hpp"
+#include "../middlewares/MetricsMiddleware.hpp"
+#include "../middlewares/SpoolMiddleware.hpp"
 
 class Router
 {
 public:
-  static crow::App<Middlewares::JWTMiddleware> &getApp()
+  // MetricsMiddleware and SpoolMiddleware run on every route; JWTMiddleware
+  // only where a route asks for it
+  using App = crow::App<Middlewares::MetricsMiddleware, Middlewares::JWTMiddleware, Middlewares::SpoolMiddleware>;
+
+  static App &getApp()
   {
-    static crow::App<Middlewares::JWTMiddleware> app;
+    static App app;
     return app;
   }
 
-  virtual void register_routes(crow::App<Middlewares::JWTMiddleware> &app) = 0;
+  virtual void register_routes(App &app) = 0;
   virtual ~Router() = default;
-};
\ No newline at end of file
+
+protected:
+  // Record the request's metrics under its rule template, so ids in the path
+  // do not each add a series; every handler calls this first
+  static void label(App &app, const crow::request &req, const char *rule)
+  {
+    app.get_context<Middlewares::MetricsMiddleware>(req).route = rule;
+  }
+};
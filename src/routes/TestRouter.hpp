@@ -7,17 +7,21 @@ namespace Routes
   class TestRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       // Run all tests
       CROW_ROUTE(app, "/api/tests/run")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::TestController::runTests(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/tests/run");
+            return Controllers::TestController::runTests(req); });
 
       // Run specific test suite
       CROW_ROUTE(app, "/api/tests/run/<string>")
-          .methods("GET"_method)([](const crow::request &req, std::string suiteName)
-                                 { return Controllers::TestController::runSuite(req, suiteName); });
+          .methods("GET"_method)([&app](const crow::request &req, std::string suiteName)
+                                 {
+            label(app, req, "/api/tests/run/<string>");
+            return Controllers::TestController::runSuite(req, suiteName); });
     }
   };
 }
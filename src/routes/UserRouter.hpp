@@ -2,35 +2,65 @@
 #include "Router.hpp"
 #include "../controllers/UserController.hpp"
 #include "../middlewares/JWTMiddleware.hpp"
+#include "../database/DatabaseExecutor.hpp"
 
 namespace Routes
 {
   class UserRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       CROW_ROUTE(app, "/api/users")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::UserController::get(); });
+          .methods("GET"_method)([&app](const crow::request &req, crow::response &res)
+                                 {
+            label(app, req, "/api/users");
+            auto &spool = app.get_context<Middlewares::SpoolMiddleware>(req).file;
+            DatabaseExecutor::respond(res, [&req, &spool]
+                                      { return Controllers::UserController::get(req, spool); }); });
+
+      // Registered before /api/users/<string> so it takes precedence
+      CROW_ROUTE(app, "/api/users/stats")
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/users/stats");
+            return Controllers::UserController::stats(); });
 
       CROW_ROUTE(app, "/api/users/<string>")
-          .methods("GET"_method)([](const crow::request &req, std::string id)
-                                 { return Controllers::UserController::getOne(std::stoi(id)); });
+          .methods("GET"_method)([&app](const crow::request &req, crow::response &res, std::string id)
+                                 {
+            label(app, req, "/api/users/<string>");
+            DatabaseExecutor::respond(res, [id]
+                                      { return Controllers::UserController::getOne(std::stoi(id)); }); });
 
       CROW_ROUTE(app, "/api/users")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::UserController::create(req); });
+          .methods("POST"_method)([&app](const crow::request &req, crow::response &res)
+                                  {
+            label(app, req, "/api/users");
+            Controllers::UserController::create(req, res); });
+
+      CROW_ROUTE(app, "/api/users/bulk")
+          .methods("POST"_method)([&app](const crow::request &req, crow::response &res)
+                                  {
+            label(app, req, "/api/users/bulk");
+            Controllers::UserController::bulkCreate(req, res); });
 
       CROW_ROUTE(app, "/api/users/<string>")
           .CROW_MIDDLEWARES(app, Middlewares::JWTMiddleware)
-          .methods("PUT"_method)([](const crow::request &req, std::string id)
-                                 { return Controllers::UserController::update(std::stoi(id), req); });
+          .methods("PUT"_method)([&app](const crow::request &req, crow::response &res, std::string id)
+                                 {
+            label(app, req, "/api/users/<string>");
+            auto caller = app.get_context<Middlewares::JWTMiddleware>(req).identity;
+            Controllers::UserController::update(std::stoi(id), req, caller, res); });
 
       CROW_ROUTE(app, "/api/users/<string>")
           .CROW_MIDDLEWARES(app, Middlewares::JWTMiddleware)
-          .methods("DELETE"_method)([](const crow::request &req, std::string id)
-                                    { return Controllers::UserController::deleteOne(std::stoi(id)); });
+          .methods("DELETE"_method)([&app](const crow::request &req, crow::response &res, std::string id)
+                                    {
+            label(app, req, "/api/users/<string>");
+            auto caller = app.get_context<Middlewares::JWTMiddleware>(req).identity;
+            DatabaseExecutor::respond(res, [id, caller]
+                                      { return Controllers::UserController::deleteOne(std::stoi(id), caller); }); });
     }
   };
 }
\ No newline at end of file
@@ -7,27 +7,35 @@ namespace Routes
   class UtilsRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       // String utilities
       CROW_ROUTE(app, "/api/utils/string")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::UtilsController::stringUtils(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/utils/string");
+            return Controllers::UtilsController::stringUtils(req); });
 
       // Date utilities
       CROW_ROUTE(app, "/api/utils/date")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::UtilsController::dateUtils(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/utils/date");
+            return Controllers::UtilsController::dateUtils(req); });
 
       // Generate random values
       CROW_ROUTE(app, "/api/utils/random")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::UtilsController::generateRandom(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/utils/random");
+            return Controllers::UtilsController::generateRandom(req); });
 
       // JSON utilities
       CROW_ROUTE(app, "/api/utils/json")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::UtilsController::jsonUtils(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/utils/json");
+            return Controllers::UtilsController::jsonUtils(req); });
     }
   };
 }
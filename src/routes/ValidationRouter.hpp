@@ -7,22 +7,28 @@ namespace Routes
   class ValidationRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       // Validate user registration
       CROW_ROUTE(app, "/api/validate/user")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::ValidationController::validateUser(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/validate/user");
+            return Controllers::ValidationController::validateUser(req); });
 
       // Validate product
       CROW_ROUTE(app, "/api/validate/product")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::ValidationController::validateProduct(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/validate/product");
+            return Controllers::ValidationController::validateProduct(req); });
 
       // Custom validation
       CROW_ROUTE(app, "/api/validate/custom")
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::ValidationController::validateCustom(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/validate/custom");
+            return Controllers::ValidationController::validateCustom(req); });
     }
   };
 }
@@ -8,7 +8,7 @@ namespace Routes
   class WebSocketRouter : public Router
   {
   public:
-    void register_routes(crow::App<Middlewares::JWTMiddleware> &app) override
+    void register_routes(App &app) override
     {
       // Register custom WebSocket event handlers
       registerCustomHandlers();
@@ -31,22 +31,30 @@ namespace Routes
 
       // HTTP endpoints for WebSocket management
       CROW_ROUTE(app, "/api/ws/stats")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::WebSocketController::getStats(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/ws/stats");
+            return Controllers::WebSocketController::getStats(req); });
 
       CROW_ROUTE(app, "/api/ws/rooms")
-          .methods("GET"_method)([](const crow::request &req)
-                                 { return Controllers::WebSocketController::getRooms(req); });
+          .methods("GET"_method)([&app](const crow::request &req)
+                                 {
+            label(app, req, "/api/ws/rooms");
+            return Controllers::WebSocketController::getRooms(req); });
 
       CROW_ROUTE(app, "/api/ws/broadcast")
           .CROW_MIDDLEWARES(app, Middlewares::JWTMiddleware)
-          .methods("POST"_method)([](const crow::request &req)
-                                  { return Controllers::WebSocketController::broadcast(req); });
+          .methods("POST"_method)([&app](const crow::request &req)
+                                  {
+            label(app, req, "/api/ws/broadcast");
+            return Controllers::WebSocketController::broadcast(req, app.get_context<Middlewares::JWTMiddleware>(req).identity); });
 
       CROW_ROUTE(app, "/api/ws/rooms/<string>/send")
           .CROW_MIDDLEWARES(app, Middlewares::JWTMiddleware)
-          .methods("POST"_method)([](const crow::request &req, std::string room)
-                                  { return Controllers::WebSocketController::sendToRoom(req, room); });
+          .methods("POST"_method)([&app](const crow::request &req, std::string room)
+                                  {
+            label(app, req, "/api/ws/rooms/<string>/send");
+            return Controllers::WebSocketController::sendToRoom(req, room, app.get_context<Middlewares::JWTMiddleware>(req).identity); });
     }
 
   private:
@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+// Fixed-size Bloom filter over keys that are already uniformly distributed,
+// such as SHA-256 digests: the k probe positions come from the first 16 bytes
+// of the key by double hashing, so nothing is rehashed. Inserts and lookups
+// are lock-free; there is no removal, rebuild a new filter instead.
+class BloomFilter
+{
+public:
+  // Sized for about a 1% false-positive rate at expectedEntries
+  explicit BloomFilter(size_t expectedEntries)
+      : BloomFilter(std::max<size_t>(64, expectedEntries * 10), 7) {}
+
+  BloomFilter(size_t bits, int hashes)
+      : words_((bits + 63) / 64), bits_(words_ * 64), hashes_(hashes),
+        data_(std::make_unique<std::atomic<uint64_t>[]>(words_))
+  {
+    for (size_t i = 0; i < words_; ++i)
+    {
+      data_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // key must be at least 16 bytes of hash output
+  void add(std::string_view key)
+  {
+    auto [h1, h2] = split(key);
+    for (int i = 0; i < hashes_; ++i)
+    {
+      size_t bit = (h1 + i * h2) % bits_;
+      data_[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+    }
+    entries_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool mightContain(std::string_view key) const
+  {
+    auto [h1, h2] = split(key);
+    for (int i = 0; i < hashes_; ++i)
+    {
+      size_t bit = (h1 + i * h2) % bits_;
+      if (!(data_[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64))))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t bits() const { return bits_; }
+  int hashes() const { return hashes_; }
+  size_t entries() const { return entries_.load(std::memory_order_relaxed); }
+
+  // False-positive rate expected at the current entry count
+  double estimatedFalsePositiveRate() const
+  {
+    double fill = 1.0 - std::exp(-static_cast<double>(hashes_) * entries() / bits_);
+    return std::pow(fill, hashes_);
+  }
+
+private:
+  size_t words_;
+  size_t bits_;
+  int hashes_;
+  std::unique_ptr<std::atomic<uint64_t>[]> data_;
+  std::atomic<size_t> entries_{0};
+
+  static std::pair<uint64_t, uint64_t> split(std::string_view key)
+  {
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    std::memcpy(&h1, key.data(), std::min<size_t>(8, key.size()));
+    if (key.size() > 8)
+    {
+      std::memcpy(&h2, key.data() + 8, std::min<size_t>(8, key.size() - 8));
+    }
+    // A zero step would probe the same bit k times
+    return {h1, h2 | 1};
+  }
+};
@@ -1,25 +1,184 @@
 #pragma once
-#include <openssl/sha.h>
-#include <sstream>
-#include <iomanip>
+#include <openssl/evp.h>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 class HashUtils
 {
 public:
+  static constexpr size_t SHA256_BYTES = 32;
+  static constexpr size_t SHA256_HEX_LENGTH = 2 * SHA256_BYTES;
+
+  using Digest = std::array<unsigned char, SHA256_BYTES>;
+
+  // Hex digest of input, e.g. for legacy password rows
   static std::string sha256(const std::string &input)
   {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, input.c_str(), input.length());
-    SHA256_Final(hash, &sha256);
+    unsigned char digest[SHA256_BYTES];
+    sha256(input.data(), input.size(), digest);
+
+    std::string hex(SHA256_HEX_LENGTH, '\0');
+    toHex(digest, SHA256_BYTES, hex.data());
+    return hex;
+  }
+
+  // Writes SHA256_BYTES bytes to out; no allocation after a thread's first call
+  static void sha256(const void *data, size_t length, unsigned char *out)
+  {
+    EVP_MD_CTX *ctx = context();
+    unsigned int written = 0;
+    if (EVP_DigestInit_ex(ctx, sha256Algorithm(), nullptr) != 1 ||
+        EVP_DigestUpdate(ctx, data, length) != 1 ||
+        EVP_DigestFinal_ex(ctx, out, &written) != 1)
+    {
+      throw std::runtime_error("SHA-256 digest failed");
+    }
+  }
+
+  static Digest sha256Digest(std::string_view input)
+  {
+    Digest digest;
+    sha256(input.data(), input.size(), digest.data());
+    return digest;
+  }
+
+  // Digest every input with one context and algorithm handle; out must hold inputs.size() entries
+  static void sha256Batch(const std::vector<std::string_view> &inputs, Digest *out)
+  {
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+      sha256(inputs[i].data(), inputs[i].size(), out[i].data());
+    }
+  }
+
+  static std::vector<std::string> sha256HexBatch(const std::vector<std::string_view> &inputs)
+  {
+    std::vector<Digest> digests(inputs.size());
+    sha256Batch(inputs, digests.data());
 
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++)
+    std::vector<std::string> hex(inputs.size(), std::string(SHA256_HEX_LENGTH, '\0'));
+    for (size_t i = 0; i < inputs.size(); ++i)
     {
-      ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+      toHex(digests[i].data(), SHA256_BYTES, hex[i].data());
     }
-    return ss.str();
+    return hex;
+  }
+
+  // Lowercase hex of length bytes into out, which must have room for 2 * length chars.
+  // Uses SSE2 sixteen bytes at a time where available, then a pair table.
+  static void toHex(const unsigned char *data, size_t length, char *out)
+  {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i letterGap = _mm_set1_epi8('a' - '0' - 10);
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+      __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+      __m128i low = _mm_and_si128(bytes, mask);
+
+      // Nibbles above 9 skip ahead from ':' to 'a'
+      high = _mm_add_epi8(_mm_add_epi8(high, zero), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letterGap));
+      low = _mm_add_epi8(_mm_add_epi8(low, zero), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letterGap));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), _mm_unpacklo_epi8(high, low));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+    const char *pairs = hexPairs();
+    for (char *dst = out + 2 * i; i < length; ++i, dst += 2)
+    {
+      std::memcpy(dst, pairs + 2 * data[i], 2);
+    }
+  }
+
+  // Inverse of toHex; false if hex is not exactly 2 * length hex digits
+  static bool fromHex(std::string_view hex, unsigned char *out, size_t length)
+  {
+    if (hex.size() != 2 * length)
+    {
+      return false;
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+      int high = hexValue(hex[2 * i]);
+      int low = hexValue(hex[2 * i + 1]);
+      if (high < 0 || low < 0)
+      {
+        return false;
+      }
+      out[i] = static_cast<unsigned char>(high << 4 | low);
+    }
+    return true;
+  }
+
+private:
+  static int hexValue(char c)
+  {
+    if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+    return -1;
+  }
+
+  struct ContextDeleter
+  {
+    void operator()(EVP_MD_CTX *ctx) const { EVP_MD_CTX_free(ctx); }
+  };
+
+  // One reusable context per thread instead of one allocation per digest
+  static EVP_MD_CTX *context()
+  {
+    thread_local std::unique_ptr<EVP_MD_CTX, ContextDeleter> ctx(EVP_MD_CTX_new());
+    if (!ctx)
+    {
+      throw std::runtime_error("EVP_MD_CTX_new failed");
+    }
+    return ctx.get();
+  }
+
+  // Fetched once: EVP_sha256() makes OpenSSL 3 look the provider up on every init
+  static const EVP_MD *sha256Algorithm()
+  {
+    static const EVP_MD *md = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+    return md;
+  }
+
+  // "000102...feff": the two hex digits of every byte value
+  static const char *hexPairs()
+  {
+    static const auto table = []
+    {
+      std::array<char, 512> pairs{};
+      const char *digits = "0123456789abcdef";
+      for (size_t b = 0; b < 256; ++b)
+      {
+        pairs[2 * b] = digits[b >> 4];
+        pairs[2 * b + 1] = digits[b & 0x0f];
+      }
+      return pairs;
+    }();
+    return table.data();
   }
-};
\ No newline at end of file
+};
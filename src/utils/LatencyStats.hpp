@@ -0,0 +1,90 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Lock-free latency histogram with power-of-two microsecond buckets.
+// Percentiles are reported as the upper bound of the bucket they fall in.
+class LatencyStats
+{
+public:
+  static constexpr size_t BUCKETS = 32; // 1us .. ~35min
+
+  void record(std::chrono::microseconds elapsed)
+  {
+    auto micros = static_cast<uint64_t>(std::max<int64_t>(0, elapsed.count()));
+    buckets_[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    totalMicros_.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t max = maxMicros_.load(std::memory_order_relaxed);
+    while (micros > max && !maxMicros_.compare_exchange_weak(max, micros, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  uint64_t count() const
+  {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  nlohmann::json toJson() const
+  {
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+      counts[i] = buckets_[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+
+    uint64_t max = maxMicros_.load(std::memory_order_relaxed);
+    // Bucket bounds can overshoot the largest sample, so cap at it
+    auto percentile = [&](double p)
+    {
+      auto rank = static_cast<uint64_t>(p * total);
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; ++i)
+      {
+        seen += counts[i];
+        if (seen > rank)
+        {
+          return std::min(upperBound(i), max);
+        }
+      }
+      return max;
+    };
+
+    return {{"count", total},
+            {"mean_us", total ? totalMicros_.load(std::memory_order_relaxed) / total : 0},
+            {"p50_us", total ? percentile(0.50) : 0},
+            {"p95_us", total ? percentile(0.95) : 0},
+            {"p99_us", total ? percentile(0.99) : 0},
+            {"max_us", max}};
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> totalMicros_{0};
+  std::atomic<uint64_t> maxMicros_{0};
+
+  // Bucket i holds values below 2^i microseconds
+  static size_t bucketFor(uint64_t micros)
+  {
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && (uint64_t(1) << bucket) <= micros)
+    {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  static uint64_t upperBound(size_t bucket)
+  {
+    return uint64_t(1) << bucket;
+  }
+};
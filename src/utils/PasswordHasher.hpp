@@ -0,0 +1,444 @@
+#pragma once
+#include "crow.h"
+#include <nlohmann/json.hpp>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "HashUtils.hpp"
+#include "LatencyStats.hpp"
+#include "StringUtils.hpp"
+#include "WorkerPool.hpp"
+#include "../config/config.hpp"
+#include "../controllers/BaseController.hpp"
+
+// scrypt cost parameters; memory use per hash is about 128 * r * 2^logN bytes
+struct KdfParams
+{
+  int logN = 15;
+  int r = 8;
+  int p = 1;
+
+  static KdfParams fromConfig()
+  {
+    return {Config::AppConfig::getScryptLogN(), Config::AppConfig::getScryptR(), Config::AppConfig::getScryptP()};
+  }
+
+  bool operator==(const KdfParams &other) const
+  {
+    return logN == other.logN && r == other.r && p == other.p;
+  }
+};
+
+// Password hashing with scrypt on a dedicated, bounded worker pool, so the
+// KDF's CPU and memory cost never lands on request threads and concurrent
+// hashes are capped at the pool size.
+//
+// Handlers run their hashing step through respond(), which ends the response
+// on the hasher thread, so neither Crow nor database executor threads wait
+// for the KDF. Inside such a step hash() and verify() run inline; called from
+// anywhere else they submit to the pool and wait.
+//
+// Stored format: $scrypt$v=1$ln=<logN>,r=<r>,p=<p>$<salt b64>$<hash b64>
+// Rows still holding the legacy unsalted SHA-256 hex digest verify, but
+// report needsRehash, as do hashes made with other cost parameters.
+class PasswordHasher : public Controllers::BaseController
+{
+public:
+  static constexpr int FORMAT_VERSION = 1;
+  static constexpr size_t SALT_BYTES = 16;
+  static constexpr size_t HASH_BYTES = 32;
+
+  struct Verification
+  {
+    bool valid = false;
+    bool needsRehash = false;
+  };
+
+  static void init(size_t threads, size_t queueSize)
+  {
+    auto &hasher = instance();
+    std::lock_guard<std::mutex> lock(hasher.mtx_);
+    if (!hasher.pool_)
+    {
+      hasher.pool_ = std::make_unique<WorkerPool>("Password hasher", threads, queueSize);
+      hasher.pool_->post(prepareDummyHash);
+    }
+  }
+
+  // Rebuild the dummy hash on the pool after the SCRYPT_* settings change,
+  // so no login pays for it; a full queue leaves it to the first login
+  static void refreshDummyHash()
+  {
+    pool().post(prepareDummyHash);
+  }
+
+  static void resize(size_t threads, size_t queueSize)
+  {
+    pool().resize(threads, queueSize);
+  }
+
+  static void shutdown()
+  {
+    auto &hasher = instance();
+    std::lock_guard<std::mutex> lock(hasher.mtx_);
+    if (hasher.pool_)
+    {
+      hasher.pool_->shutdown();
+    }
+  }
+
+  // Hash on the pool and wait, or inline on a hasher thread; throws
+  // QueueFullError when the pool is saturated
+  static std::string hash(const std::string &password)
+  {
+    return run(instance().hashLatency_, [password]
+               { return hashNow(password, KdfParams::fromConfig()); });
+  }
+
+  static Verification verify(const std::string &password, const std::string &stored)
+  {
+    return run(instance().verifyLatency_, [password, stored]
+               { return verifyNow(password, stored); });
+  }
+
+  // Spend the same work as verify() for an account that does not exist, so
+  // response time does not reveal which emails are registered
+  static void verifyDummy(const std::string &password)
+  {
+    run(instance().verifyLatency_, [password]
+        { return verifyNow(password, dummyHash()); });
+  }
+
+  // Run a handler that produces a crow::response on a hasher thread and
+  // complete res with it, like DatabaseExecutor::respond; the handler may
+  // return std::nullopt after passing res on to the database executor
+  template <typename F>
+  static void respond(crow::response &res, F &&handler)
+  {
+    auto queuedAt = std::chrono::steady_clock::now();
+    bool queued = pool().post([&res, queuedAt, handler = std::forward<F>(handler)]() mutable
+                              {
+      PoolTask task;
+      instance().queueLatency_.record(elapsedSince(queuedAt));
+      try
+      {
+        complete(res, handler());
+      }
+      catch (const std::exception &e)
+      {
+        complete(res, server_error(e.what()));
+      } });
+
+    if (!queued)
+    {
+      complete(res, service_unavailable("Password hashing is busy, try again later"));
+    }
+  }
+
+  // Replace every plaintext in place with its hash, spread across at most
+  // half the pool's threads so logins keep the rest. Returns at once; done
+  // runs once, on whichever thread finishes last, with the first error if
+  // any (e.g. QueueFullError). The strings must outlive done.
+  static void hashAll(std::vector<std::string *> passwords, std::function<void(std::exception_ptr)> done)
+  {
+    struct Batch
+    {
+      std::vector<std::string *> passwords;
+      std::function<void(std::exception_ptr)> done;
+      // Queued chunks, plus one held by hashAll until it has queued them all
+      std::atomic<size_t> remaining{1};
+      std::mutex mtx;
+      std::exception_ptr error;
+
+      void fail(std::exception_ptr e)
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!error)
+        {
+          error = e;
+        }
+      }
+
+      void release()
+      {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+          done(error);
+        }
+      }
+    };
+
+    auto &hasher = instance();
+    auto batch = std::make_shared<Batch>();
+    batch->passwords = std::move(passwords);
+    batch->done = std::move(done);
+
+    auto params = KdfParams::fromConfig();
+    size_t count = batch->passwords.size();
+    size_t threads = std::max<size_t>(1, pool().threads() / 2);
+    size_t chunk = (count + threads - 1) / threads;
+
+    for (size_t begin = 0; begin < count; begin += chunk)
+    {
+      size_t end = std::min(begin + chunk, count);
+      batch->remaining.fetch_add(1, std::memory_order_relaxed);
+      bool queued = pool().post([batch, &hasher, params, begin, end]
+                                {
+        PoolTask task;
+        try
+        {
+          for (size_t i = begin; i < end; ++i)
+          {
+            auto start = std::chrono::steady_clock::now();
+            *batch->passwords[i] = hashNow(*batch->passwords[i], params);
+            hasher.hashLatency_.record(elapsedSince(start));
+          }
+        }
+        catch (...)
+        {
+          batch->fail(std::current_exception());
+        }
+        batch->release(); });
+
+      if (!queued)
+      {
+        // Chunks already queued still run; done waits for them
+        batch->remaining.fetch_sub(1, std::memory_order_relaxed);
+        batch->fail(std::make_exception_ptr(QueueFullError("Password hasher queue is full")));
+        break;
+      }
+    }
+    batch->release();
+  }
+
+  static std::string hashNow(const std::string &password, const KdfParams &params)
+  {
+    unsigned char salt[SALT_BYTES];
+    if (RAND_bytes(salt, sizeof(salt)) != 1)
+    {
+      throw std::runtime_error("RAND_bytes failed");
+    }
+
+    auto derived = derive(password, salt, sizeof(salt), params);
+    return "$scrypt$v=" + std::to_string(FORMAT_VERSION) +
+           "$ln=" + std::to_string(params.logN) + ",r=" + std::to_string(params.r) + ",p=" + std::to_string(params.p) +
+           "$" + base64(salt, sizeof(salt)) + "$" + base64(derived.data(), derived.size());
+  }
+
+  static Verification verifyNow(const std::string &password, const std::string &stored)
+  {
+    if (stored.rfind("$scrypt$", 0) != 0)
+    {
+      // Legacy unsalted SHA-256 hex
+      auto legacy = HashUtils::sha256(password);
+      bool valid = legacy.size() == stored.size() &&
+                   CRYPTO_memcmp(legacy.data(), stored.data(), legacy.size()) == 0;
+      return {valid, valid};
+    }
+
+    // "", "scrypt", "v=1", "ln=..,r=..,p=..", salt, hash
+    auto parts = StringUtils::split(stored, '$');
+    KdfParams params;
+    if (parts.size() != 6 || parts[2] != "v=" + std::to_string(FORMAT_VERSION) ||
+        std::sscanf(parts[3].c_str(), "ln=%d,r=%d,p=%d", &params.logN, &params.r, &params.p) != 3)
+    {
+      return {false, false};
+    }
+    // Same bounds as SCRYPT_LOG_N, SCRYPT_R and SCRYPT_P; a corrupt row must
+    // not shift past 64 bits or ask for unbounded memory
+    if (params.logN < 10 || params.logN > 22 || params.r < 1 || params.r > 32 || params.p < 1 || params.p > 16)
+    {
+      return {false, false};
+    }
+
+    auto salt = unbase64(parts[4]);
+    auto expected = unbase64(parts[5]);
+    if (salt.empty() || expected.size() != HASH_BYTES)
+    {
+      return {false, false};
+    }
+
+    auto derived = derive(password, salt.data(), salt.size(), params);
+    bool valid = CRYPTO_memcmp(derived.data(), expected.data(), HASH_BYTES) == 0;
+    return {valid, valid && !(params == KdfParams::fromConfig())};
+  }
+
+  static nlohmann::json stats()
+  {
+    auto &hasher = instance();
+    auto &workers = pool();
+    return {{"threads", workers.threads()},
+            {"queued", workers.queued()},
+            {"capacity", workers.capacity()},
+            {"rejected", workers.rejected()},
+            {"queue_wait", hasher.queueLatency_.toJson()},
+            {"hash", hasher.hashLatency_.toJson()},
+            {"verify", hasher.verifyLatency_.toJson()}};
+  }
+
+private:
+  std::unique_ptr<WorkerPool> pool_;
+  std::mutex mtx_;
+  // Separate from mtx_, which pool() takes on every call
+  std::mutex dummyMtx_;
+  KdfParams dummyParams_;
+  std::string dummyHash_;
+  LatencyStats queueLatency_;
+  LatencyStats hashLatency_;
+  LatencyStats verifyLatency_;
+
+  static PasswordHasher &instance()
+  {
+    static PasswordHasher instance;
+    return instance;
+  }
+
+  static WorkerPool &pool()
+  {
+    auto &hasher = instance();
+    {
+      std::lock_guard<std::mutex> lock(hasher.mtx_);
+      if (hasher.pool_)
+      {
+        return *hasher.pool_;
+      }
+    }
+    init(Config::AppConfig::getPasswordHashThreads(), Config::AppConfig::getPasswordHashQueueSize());
+    return *hasher.pool_;
+  }
+
+  // Build the hash verifyDummy checks against for the current KDF params
+  static void prepareDummyHash()
+  {
+    auto &hasher = instance();
+    auto params = KdfParams::fromConfig();
+    {
+      std::lock_guard<std::mutex> lock(hasher.dummyMtx_);
+      if (!hasher.dummyHash_.empty() && hasher.dummyParams_ == params)
+      {
+        return;
+      }
+    }
+
+    // Computed without the lock; concurrent builders just race to store
+    unsigned char random[SALT_BYTES];
+    if (RAND_bytes(random, sizeof(random)) != 1)
+    {
+      throw std::runtime_error("RAND_bytes failed");
+    }
+    auto dummy = hashNow(base64(random, sizeof(random)), params);
+
+    std::lock_guard<std::mutex> lock(hasher.dummyMtx_);
+    hasher.dummyHash_ = std::move(dummy);
+    hasher.dummyParams_ = params;
+  }
+
+  // The dummy hash for the current cost; normally already built by
+  // prepareDummyHash, otherwise built here once
+  static std::string dummyHash()
+  {
+    prepareDummyHash();
+    auto &hasher = instance();
+    std::lock_guard<std::mutex> lock(hasher.dummyMtx_);
+    return hasher.dummyHash_;
+  }
+
+  // True on a hasher thread while it runs one of this class's tasks
+  static bool &onPool()
+  {
+    thread_local bool on = false;
+    return on;
+  }
+
+  struct PoolTask
+  {
+    PoolTask() { onPool() = true; }
+    ~PoolTask() { onPool() = false; }
+  };
+
+  static std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  }
+
+  // Submit fn, recording queue wait and run time separately so the pool can
+  // be sized: long waits mean too few threads, long runs mean costly params.
+  // On a hasher thread fn runs inline, since waiting there could deadlock.
+  template <typename F>
+  static auto run(LatencyStats &latency, F &&fn) -> std::invoke_result_t<std::decay_t<F>>
+  {
+    if (onPool())
+    {
+      auto start = std::chrono::steady_clock::now();
+      auto result = fn();
+      latency.record(elapsedSince(start));
+      return result;
+    }
+
+    auto queuedAt = std::chrono::steady_clock::now();
+    auto future = pool().submit([queuedAt, &latency, fn = std::forward<F>(fn)]
+                                {
+      PoolTask task;
+      auto start = std::chrono::steady_clock::now();
+      instance().queueLatency_.record(std::chrono::duration_cast<std::chrono::microseconds>(start - queuedAt));
+      auto result = fn();
+      latency.record(elapsedSince(start));
+      return result; });
+    return future.get();
+  }
+
+  static std::vector<unsigned char> derive(const std::string &password, const unsigned char *salt, size_t saltLength,
+                                           const KdfParams &params)
+  {
+    uint64_t n = uint64_t(1) << params.logN;
+    // OpenSSL's default limit is 32MB, below what our defaults need
+    uint64_t maxmem = 128 * uint64_t(params.r) * (n + 2 + params.p) + (1 << 20);
+
+    std::vector<unsigned char> derived(HASH_BYTES);
+    if (EVP_PBE_scrypt(password.data(), password.size(), salt, saltLength, n, params.r, params.p, maxmem,
+                       derived.data(), derived.size()) != 1)
+    {
+      throw std::runtime_error("scrypt failed");
+    }
+    return derived;
+  }
+
+  static std::string base64(const unsigned char *data, size_t length)
+  {
+    std::string out(4 * ((length + 2) / 3), '\0');
+    int written = EVP_EncodeBlock(reinterpret_cast<unsigned char *>(out.data()), data, static_cast<int>(length));
+    out.resize(static_cast<size_t>(written));
+    return out;
+  }
+
+  static std::vector<unsigned char> unbase64(const std::string &text)
+  {
+    if (text.empty() || text.size() % 4 != 0)
+    {
+      return {};
+    }
+
+    std::vector<unsigned char> out(3 * text.size() / 4);
+    int written = EVP_DecodeBlock(out.data(), reinterpret_cast<const unsigned char *>(text.data()), static_cast<int>(text.size()));
+    if (written < 0)
+    {
+      return {};
+    }
+
+    // EVP_DecodeBlock counts padding as zero bytes
+    size_t padding = (text.back() == '=') + (text.size() > 1 && text[text.size() - 2] == '=');
+    out.resize(static_cast<size_t>(written) - padding);
+    return out;
+  }
+};
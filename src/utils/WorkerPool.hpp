@@ -0,0 +1,224 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Raised by WorkerPool::submit when the queue is at capacity
+class QueueFullError : public std::exception
+{
+public:
+  explicit QueueFullError(std::string message) : message_(std::move(message)) {}
+  const char *what() const noexcept override { return message_.c_str(); }
+
+private:
+  std::string message_;
+};
+
+// Fixed-size thread pool with a bounded FIFO queue
+class WorkerPool
+{
+public:
+  WorkerPool(std::string name, size_t threads, size_t queueCapacity)
+      : name_(std::move(name)), capacity_(std::max<size_t>(1, queueCapacity))
+  {
+    threads = std::max<size_t>(1, threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+      workers_.emplace_back(&WorkerPool::run, this);
+    }
+    active_ = threads;
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool()
+  {
+    shutdown();
+  }
+
+  // Queue a task and get a future for its result; throws QueueFullError when saturated
+  template <typename F>
+  auto submit(F &&fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+  {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+    auto future = task->get_future();
+
+    if (!post([task]
+              { (*task)(); }))
+    {
+      throw QueueFullError(name_ + " queue is full");
+    }
+    return future;
+  }
+
+  // Queue a fire-and-forget task; returns false when the queue is full or stopped
+  bool post(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (stopping_ || queue_.size() >= capacity_)
+      {
+        ++rejected_;
+        return false;
+      }
+      queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  // Stop accepting work, drain what is queued and join the workers
+  void shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (stopping_)
+      {
+        return;
+      }
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_)
+    {
+      if (worker.joinable())
+      {
+        worker.join();
+      }
+    }
+  }
+
+  // Change the thread count and queue capacity of a running pool. Surplus
+  // workers exit after their current task; queued work is kept.
+  void resize(size_t threads, size_t queueCapacity)
+  {
+    threads = std::max<size_t>(1, threads);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (stopping_)
+      {
+        return;
+      }
+      capacity_ = std::max<size_t>(1, queueCapacity);
+      reapRetired();
+
+      if (threads > active_)
+      {
+        // Workers that were asked to exit but have not yet are kept instead
+        size_t kept = std::min(retiring_, threads - active_);
+        retiring_ -= kept;
+        for (size_t i = active_ + kept; i < threads; ++i)
+        {
+          workers_.emplace_back(&WorkerPool::run, this);
+        }
+      }
+      else
+      {
+        retiring_ += active_ - threads;
+      }
+      active_ = threads;
+    }
+    cv_.notify_all();
+  }
+
+  size_t queued() const
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return queue_.size();
+  }
+
+  size_t threads() const
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return active_;
+  }
+
+  size_t capacity() const
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return capacity_;
+  }
+
+  uint64_t rejected() const
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return rejected_;
+  }
+
+private:
+  std::string name_;
+  size_t capacity_;
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> queue_;
+  mutable std::mutex mtx_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+  size_t active_ = 0;
+  size_t retiring_ = 0;
+  // Workers that exited on a shrink and still have to be joined
+  std::vector<std::thread::id> retired_;
+  uint64_t rejected_ = 0;
+
+  // Join the workers a shrink retired, so workers_ only holds live threads.
+  // They have left run() once listed here, so the joins are immediate.
+  void reapRetired()
+  {
+    for (auto id : retired_)
+    {
+      auto it = std::find_if(workers_.begin(), workers_.end(), [id](const std::thread &worker)
+                             { return worker.get_id() == id; });
+      if (it != workers_.end())
+      {
+        it->join();
+        workers_.erase(it);
+      }
+    }
+    retired_.clear();
+  }
+
+  void run()
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]
+                 { return stopping_ || retiring_ > 0 || !queue_.empty(); });
+        if (retiring_ > 0)
+        {
+          --retiring_;
+          retired_.push_back(std::this_thread::get_id());
+          return;
+        }
+        if (queue_.empty())
+        {
+          return;
+        }
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        // Tasks own their error reporting; never let one take down a worker
+      }
+    }
+  }
+};